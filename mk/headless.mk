@@ -0,0 +1,16 @@
+# A display-less platform for benchmarking and exercising the core logic
+# (see src/platform/headless/headless.c).
+
+CFILES=$(shell find src/*.c src/platform/headless/*.c) src/platform/linux/inputq.c
+OBJECTS=$(CFILES:.c=.o)
+
+all: $(OBJECTS)
+	-mkdir bin
+	$(CC)  -o bin/warpd $(OBJECTS) $(CFLAGS)
+clean:
+	-rm $(OBJECTS)
+	-rm -r bin
+test: all
+	./test/run.sh
+bench: all
+	./test/bench.sh
@@ -15,6 +15,8 @@ ifndef DISABLE_X
 		-lXfixes\
 		-lXext\
 		-lXinerama\
+		-lXrandr\
+		-lXpresent\
 		-lXi\
 		-lXtst\
 		-lX11\
@@ -22,6 +24,18 @@ ifndef DISABLE_X
 		-DWARPD_X=1
 
 	CFILES+=$(shell find src/platform/linux/X/*.c)
+
+	# Use XCB for request batching where Xlib would block on each reply.
+	ifdef X_XCB
+		CFLAGS+=-lX11-xcb\
+			-lxcb\
+			-lxcb-xinerama\
+			-lxcb-randr\
+			-lxcb-xinput\
+			-DWARPD_XCB=1
+	else
+		CFILES:=$(filter-out src/platform/linux/X/xcb.c, $(CFILES))
+	endif
 endif
 
 OBJECTS=$(CFILES:.c=.o)
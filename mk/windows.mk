@@ -1,7 +1,7 @@
 #CC=cl.exe
 CC=x86_64-w64-mingw32-gcc
 CFLAGS+=-DWINDOWS -luser32 -lgdi32 -mwindows
-OBJFILES=$(shell find src/*.c src/windows/*.c src/platform/windows/*.c ! -name 'warpd.c' )
+OBJFILES=$(shell find src/*.c src/windows/*.c src/platform/windows/*.c ! -name 'warpd.c' ! -name 'ipc.c' ! -name 'batch.c' ! -name 'trace.c' )
 
 ifeq ($(CC), cl.exe)
 OBJFILES:=$(OBJFILES:%.c=%.obj)
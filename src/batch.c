@@ -0,0 +1,170 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * Executes a stream of newline separated pointer commands read from stdin
+ * (--batch). Supported commands:
+ *
+ *	move <x> <y>
+ *	click <button>
+ *	down <button>
+ *	up <button>
+ *	scroll <up|down|left|right> [count]
+ *	sleep <ms>
+ *
+ * Blank lines and lines starting with '#' are ignored. Commands are
+ * committed once for every chunk of input read (and before each sleep)
+ * rather than after each command, so the backend can pipeline them.
+ */
+
+#include "warpd.h"
+
+#include <errno.h>
+
+static screen_t scr;
+static size_t nr_commands;
+
+static int parse_scroll_direction(const char *s)
+{
+	if (!strcmp(s, "up"))
+		return SCROLL_UP;
+	if (!strcmp(s, "down"))
+		return SCROLL_DOWN;
+	if (!strcmp(s, "left"))
+		return SCROLL_LEFT;
+	if (!strcmp(s, "right"))
+		return SCROLL_RIGHT;
+
+	return -1;
+}
+
+static void sleep_ms(int ms)
+{
+	struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+
+	while (nanosleep(&ts, &ts) && errno == EINTR)
+		;
+}
+
+/* Returns -1 on invalid input. */
+static int run_command(char *line)
+{
+	char cmd[16];
+	char arg[16];
+	int a, b;
+	int n;
+
+	while (*line == ' ' || *line == '\t')
+		line++;
+
+	if (!*line || *line == '#')
+		return 0;
+
+	if (sscanf(line, "%15s", cmd) != 1)
+		return -1;
+
+	if (!strcmp(cmd, "move")) {
+		if (sscanf(line, "%*s %d %d", &a, &b) != 2)
+			return -1;
+
+		platform->mouse_move(scr, a, b);
+	} else if (!strcmp(cmd, "click")) {
+		if (sscanf(line, "%*s %d", &a) != 1)
+			return -1;
+
+		platform->mouse_click(a);
+	} else if (!strcmp(cmd, "down")) {
+		if (sscanf(line, "%*s %d", &a) != 1)
+			return -1;
+
+		platform->mouse_down(a);
+	} else if (!strcmp(cmd, "up")) {
+		if (sscanf(line, "%*s %d", &a) != 1)
+			return -1;
+
+		platform->mouse_up(a);
+	} else if (!strcmp(cmd, "scroll")) {
+		int direction;
+
+		n = sscanf(line, "%*s %15s %d", arg, &b);
+		if (n < 1 || (direction = parse_scroll_direction(arg)) < 0)
+			return -1;
+
+		for (a = 0; a < (n == 2 ? b : 1); a++)
+			platform->scroll(direction);
+	} else if (!strcmp(cmd, "sleep")) {
+		if (sscanf(line, "%*s %d", &a) != 1 || a < 0)
+			return -1;
+
+		platform->commit();
+		sleep_ms(a);
+	} else {
+		return -1;
+	}
+
+	nr_commands++;
+	return 0;
+}
+
+int batch_run()
+{
+	char buf[65536];
+	size_t len = 0;
+	size_t lineno = 0;
+	uint64_t start = get_time_us();
+	uint64_t elapsed;
+
+	platform->mouse_get_position(&scr, NULL, NULL);
+
+	while (1) {
+		char *line, *nl;
+		ssize_t ret = read(0, buf + len, sizeof buf - len - 1);
+
+		if (ret < 0 && errno == EINTR)
+			continue;
+
+		if (ret <= 0) {
+			/* Treat a trailing unterminated line as complete. */
+			if (!len)
+				break;
+
+			buf[len++] = '\n';
+		} else {
+			len += ret;
+		}
+
+		line = buf;
+		while ((nl = memchr(line, '\n', buf + len - line))) {
+			*nl = 0;
+			lineno++;
+
+			if (run_command(line)) {
+				platform->commit();
+				fprintf(stderr, "ERROR: line %zu: invalid command: %s\n", lineno, line);
+				return -1;
+			}
+
+			line = nl + 1;
+		}
+
+		len = buf + len - line;
+		memmove(buf, line, len);
+
+		if (len == sizeof buf - 1) {
+			fprintf(stderr, "ERROR: line %zu: line too long\n", lineno + 1);
+			return -1;
+		}
+
+		platform->commit();
+	}
+
+	elapsed = get_time_us() - start;
+	fprintf(stderr, "%zu commands in %lu us (%.0f commands/sec)\n",
+		nr_commands, (unsigned long)elapsed,
+		elapsed ? nr_commands * 1E6 / elapsed : 0);
+
+	return 0;
+}
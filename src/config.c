@@ -5,7 +5,67 @@
 #include <string.h>
 #include <stdlib.h>
 
-struct config_entry *config = NULL;
+struct config_entry {
+	char key[32];
+	char value[64];
+	enum option_type type;
+	enum config_option option;
+
+	struct config_entry *next;
+};
+
+/*
+ * Key bindings are compiled into a table of (code, mods) -> (option, index)
+ * entries whenever the config or the active whitelist changes, so that
+ * matching an input event never involves any string processing.
+ *
+ * Bindings are stored in order of precedence (i.e the order of the config
+ * list), and ties are resolved in favour of the first whitelisted binding
+ * for a given key, which may shadow the option being matched.
+ */
+
+#define MAX_BINDINGS 1024
+
+struct binding {
+	uint8_t code;
+	uint8_t mods;
+	uint8_t idx; /* 1-based index within the option value. */
+	uint8_t option;
+
+	enum option_type type;
+	size_t prio;
+};
+
+/*
+ * A fully parsed config. A new snapshot is built from scratch by
+ * parse_config() and swapped in once it is complete, so lookups never
+ * observe a partially loaded config.
+ */
+struct config {
+	/* Ordered by precedence (most recent first). */
+	struct config_entry *entries;
+
+	/* The effective value of each option. */
+	struct {
+		const char *str;
+		int i;
+		uint32_t color; /* 0xRRGGBBAA */
+	} values[NR_CONFIG_OPTIONS];
+
+	struct binding bindings[MAX_BINDINGS];
+	size_t nr_bindings;
+
+	/* The precedence of the first 'unbind' entry for each option (if any). */
+	size_t unbind_prio[NR_CONFIG_OPTIONS];
+};
+
+static struct config *config = NULL;
+
+/* Incremented whenever bindings are re-resolved against a new keymap. */
+static int keymap_serial;
+
+/* Options whose value differs from the previously loaded config. */
+static uint64_t changed[(NR_CONFIG_OPTIONS + 63) / 64];
 
 static struct {
 	char *key;
@@ -14,140 +74,36 @@ static struct {
 	const char *description;
 	enum option_type type;
 } options[] = {
-	{ "hint_activation_key", "A-M-x", "Activates hint mode.", OPT_KEY },
-	{ "hint2_activation_key", "A-M-X", "Activate two pass hint mode.", OPT_KEY },
-	{ "grid_activation_key", "A-M-g", "Activates grid mode and allows for further manipulation of the pointer using the mapped keys.", OPT_KEY },
-	{ "history_activation_key", "A-M-h", "Activate history mode.", OPT_KEY },
-	{ "screen_activation_key", "A-M-s", "Activate (s)creen selection mode.", OPT_KEY },
-	{ "activation_key", "A-M-c", "Activate normal movement mode (manual (c)ursor movement).", OPT_KEY },
-
-	{ "hint_oneshot_key", "A-M-l", "Activate hint mode and exit upon selection.", OPT_KEY },
-	{ "hint2_oneshot_key", "A-M-L", "Activate two pass hint mode and exit upon selection.", OPT_KEY },
-
-	/* Normal mode keys */
-
-	{ "exit", "esc", "Exit the currently active warpd session.", OPT_KEY },
-	{ "drag", "v", "Toggle drag mode (mnemonic (v)isual mode).", OPT_KEY },
-	{ "copy_and_exit", "c", "Send the copy key and exit (useful in combination with v).", OPT_KEY },
-	{ "accelerator", "a", "Increase the acceleration of the pointer while held.", OPT_KEY },
-	{ "decelerator", "d", "Decrease the speed of the pointer while held.", OPT_KEY },
-	{ "buttons", "m , .",  "A space separated list of mouse buttons (2 is middle click).", OPT_BUTTON },
-	{ "drag_button", "1", "The mouse buttton used for dragging.", OPT_INT },
-	{ "oneshot_buttons", "n - /", "Oneshot mouse buttons (deactivate on click).", OPT_BUTTON },
-
-	{ "print", "p", "Print the current mouse coordinates to stdout (useful for scripts).", OPT_KEY },
-	{ "history", ";", "Activate hint history mode while in normal mode.", OPT_KEY },
-	{ "hint", "x", "Activate hint mode while in normal mode (mnemonic: x marks the spot?).", OPT_KEY },
-	{ "hint2", "X", "Activate two pass hint mode.", OPT_KEY },
-	{ "grid", "g", "Activate (g)rid mode while in normal mode.", OPT_KEY },
-	{ "screen", "s", "Activate (s)creen selection while in normal mode.", OPT_KEY },
-
-	{ "left", "h", "Move the cursor left in normal mode.", OPT_KEY },
-	{ "down", "j", "Move the cursor down in normal mode.", OPT_KEY },
-	{ "up", "k", "Move the cursor up in normal mode.", OPT_KEY },
-	{ "right", "l", "Move the cursor right in normal mode.", OPT_KEY },
-	{ "top", "H", "Moves the cursor to the top of the screen in normal mode.", OPT_KEY },
-	{ "middle", "M", "Moves the cursor to the middle of the screen in normal mode.", OPT_KEY },
-	{ "bottom", "L", "Moves the cursor to the bottom of the screen in normal mode.", OPT_KEY },
-	{ "start", "0", "Moves the cursor to the leftmost corner of the screen in normal mode.", OPT_KEY },
-	{ "end", "$", "Moves the cursor to the rightmost corner of the screen in normal mode.", OPT_KEY },
-
-	{ "scroll_down", "e", "Scroll down key.", OPT_KEY },
-	{ "scroll_up", "r", "Scroll up key.", OPT_KEY },
-
-	{ "cursor_color", "#FF4500", "The color of the pointer in normal mode (rgba hex value).", OPT_STRING },
-
-	{ "cursor_size", "7", "The height of the pointer in normal mode.", OPT_INT },
-	{ "repeat_interval", "20", "The number of milliseconds before repeating a movement event.", OPT_INT },
-	{ "speed", "220", "Pointer speed in pixels/second.", OPT_INT },
-	{ "max_speed", "1600", "The maximum pointer speed.", OPT_INT },
-	{ "decelerator_speed", "50", "Pointer speed while decelerator is depressed.", OPT_INT },
-	{ "acceleration", "700", "Pointer acceleration in pixels/second^2.", OPT_INT },
-	{ "accelerator_acceleration", "2900", "Pointer acceleration while the accelerator is depressed.", OPT_INT },
-	{ "oneshot_timeout", "300", "The length of time in milliseconds to wait for a second click after a oneshot key has been pressed.", OPT_INT },
-	{ "hist_hint_size", "2", "History hint size as a percentage of screen height.", OPT_INT },
-	{ "grid_nr", "2", "The number of rows in the grid.", OPT_INT },
-	{ "grid_nc", "2", "The number of columns in the grid.", OPT_INT },
-
-	{ "hist_back", "C-o", "Move to the last position in the history stack.", OPT_KEY },
-	{ "hist_forward", "C-i", "Move to the next position in the history stack.", OPT_KEY },
-
-	{ "grid_up", "w", "Move the grid up.", OPT_KEY },
-	{ "grid_left", "a", "Move the grid left.", OPT_KEY },
-	{ "grid_down", "s", "Move the grid down.", OPT_KEY },
-	{ "grid_right", "d", "Move the grid right.", OPT_KEY },
-	{ "grid_cut_up", "W", "Cut the grid up.", OPT_KEY },
-	{ "grid_cut_left", "A", "Cut the grid left.", OPT_KEY },
-	{ "grid_cut_down", "S", "Cut the grid down.", OPT_KEY },
-	{ "grid_cut_right", "D", "Cut the grid right.", OPT_KEY },
-	{ "grid_keys", "u i j k", "A sequence of comma delimited keybindings which are ordered bookwise with respect to grid position.", OPT_KEY },
-	{ "grid_exit", "c", "Exit grid mode and return to normal mode.", OPT_KEY },
-
-	{ "grid_size", "4", "The thickness of grid lines in pixels.", OPT_INT },
-	{ "grid_border_size", "0", "The thickness of the grid border in pixels.", OPT_INT },
-
-	{ "grid_color", "#1c1c1e", "The color of the grid.", OPT_STRING },
-	{ "grid_border_color", "#ffffff", "The color of the grid border.", OPT_STRING },
-
-	{ "hint_bgcolor", "#1c1c1e", "The background hint color.", OPT_STRING },
-	{ "hint_fgcolor", "#a1aba7", "The foreground hint color.", OPT_STRING },
-	{ "hint_chars", "abcdefghijklmnopqrstuvwxyz", "The character set from which hints are generated. The total number of hints is the square of the size of this string. It may be desirable to increase this for larger screens or trim it to increase gaps between hints.", OPT_STRING },
-	{ "hint_font", "Arial", "The font name used by hints. Note: This is platform specific, in X it corresponds to a valid xft font name, on macos it corresponds to a postscript name.", OPT_STRING },
-
-	{ "hint_size", "20", "Hint size (range: 1-1000)", OPT_INT },
-	{ "hint_border_radius", "3", "Border radius.", OPT_INT },
-
-	{ "hint_exit", "esc", "The exit key used for hint mode.", OPT_KEY },
-	{ "hint_undo", "backspace", "undo last selection step in one of the hint based modes.", OPT_KEY },
-	{ "hint_undo_all", "C-u", "undo all selection steps in one of the hint based modes.", OPT_KEY },
-
-	{ "hint2_chars", "hjkl;asdfgqwertyuiopzxcvb", "The character set used for the second hint selection, should consist of at least hint2_grid_size^2 characters.", OPT_STRING },
-	{ "hint2_size", "20", "The size of hints in the secondary grid (range: 1-1000).", OPT_INT },
-	{ "hint2_gap_size", "1", "The spacing between hints in the secondary grid. (range: 1-1000)", OPT_INT },
-	{ "hint2_grid_size", "3", "The size of the secondary grid.", OPT_INT },
-
-	{ "screen_chars", "jkl;asdfg", "The characters used for screen selection.", OPT_STRING },
-
-	{ "scroll_speed", "300", "Initial scroll speed in units/second (unit varies by platform).", OPT_INT },
-	{ "scroll_max_speed", "9000", "Maximum scroll speed.", OPT_INT },
-	{ "scroll_acceleration", "1600", "Scroll acceleration in units/second^2.", OPT_INT },
-	{ "scroll_deceleration", "-3400", "Scroll deceleration.", OPT_INT },
-
-	{ "indicator", "none", "Specifies an optional visual indicator to be displayed while normal mode is active, must be one of: topright, topleft, bottomright, bottomleft, none", OPT_STRING },
-	{ "indicator_color", "#00ff00", "The color of the visual indicator color.", OPT_STRING },
-	{ "indicator_size", "12", "The size of the visual indicator in pixels.", OPT_INT },
-
-	{ "normal_system_cursor", "0", "If set to non-zero, use the system cursor instead of warpd's internal one.", OPT_INT },
-	{ "normal_blink_interval", "0", "If set to non-zero, the blink interval of the normal mode cursor in miliseconds. If two values are supplied, the first corresponds to the time the cursor is visible, and the second corresponds to the amount of time it is invisible", OPT_STRING },
+#define X(id, name, val, description, type) { name, val, description, type },
+#include "options.h"
+#undef X
 };
 
-const char *config_get(const char *key)
+const char *config_get(enum config_option option)
 {
-	struct config_entry *ent;
-
-	for (ent = config; ent; ent = ent->next)
-		if (!strcmp(ent->key, key))
-			return ent->value;
+	return config->values[option].str;
+}
 
-	fprintf(stderr, "FATAL: unrecognized config entry: %s\n", key);
-	exit(-1);
+int config_get_int(enum config_option option)
+{
+	return config->values[option].i;
 }
 
-int config_get_int(const char *key)
+uint32_t config_get_color(enum config_option option)
 {
-	return atoi(config_get(key));
+	return config->values[option].color;
 }
 
-enum option_type get_option_type(const char *key)
+static int lookup_option(const char *key)
 {
 	size_t i;
 
 	for (i = 0; i < sizeof(options) / sizeof(options[0]); i++) {
 		if (!strcmp(options[i].key, key))
-			return options[i].type;
+			return i;
 	}
 
-	return 0;
+	return -1;
 }
 
 static void validate_key_option(const char *s)
@@ -169,8 +125,33 @@ static void validate_key_option(const char *s)
 	}
 }
 
-static void config_add(const char *key, const char *val)
+/* Parses #RRGGBB[AA] into 0xRRGGBBAA. */
+static int parse_color(const char *s, uint32_t *color)
 {
+	size_t i, len;
+
+	if (s[0] == '#')
+		s++;
+
+	len = strlen(s);
+	if (len != 6 && len != 8)
+		return -1;
+
+	for (i = 0; i < len; i++)
+		if (!isxdigit(s[i]))
+			return -1;
+
+	*color = strtoul(s, NULL, 16);
+	if (len == 6)
+		*color = *color << 8 | 0xFF;
+
+	return 0;
+}
+
+static void config_add(struct config *cfg, const char *key, const char *val)
+{
+	int opt;
+	uint32_t color = 0;
 	struct config_entry *ent;
 	ent = malloc(sizeof(struct config_entry));
 
@@ -180,12 +161,15 @@ static void config_add(const char *key, const char *val)
 	strcpy(ent->key, key);
 	strcpy(ent->value, val);
 
-	ent->type = get_option_type(key);
-	if (!ent->type) {
+	opt = lookup_option(key);
+	if (opt < 0) {
 		free(ent);
 		return;
 	}
 
+	ent->option = opt;
+	ent->type = options[opt].type;
+
 	switch (ent->type) {
 		int i;
 
@@ -196,6 +180,15 @@ static void config_add(const char *key, const char *val)
 					exit(-1);
 				}
 			break;
+		case OPT_COLOR:
+			/* Keep the previous (or default) value. */
+			if (parse_color(ent->value, &color)) {
+				fprintf(stderr, "ERROR: %s is not a valid rgb(a) hex value, ignoring %s\n",
+					ent->value, ent->key);
+				free(ent);
+				return;
+			}
+			break;
 		case OPT_BUTTON:
 		case OPT_KEY:
 			validate_key_option(ent->value);
@@ -207,27 +200,150 @@ static void config_add(const char *key, const char *val)
 
 	}
 
-	ent->next = config;
+	ent->next = cfg->entries;
+	cfg->entries = ent;
 
-	config = ent;
+	cfg->values[opt].str = ent->value;
+	cfg->values[opt].i = atoi(ent->value);
+	cfg->values[opt].color = color;
 }
 
-void parse_config(const char *path)
+static void compile_bindings(struct config *cfg)
 {
 	size_t i;
+	size_t prio;
+	struct config_entry *ent;
 
-	FILE *fh = (path[0] == '-' && path[1] == 0) ? stdin : fopen(path, "r");
+	cfg->nr_bindings = 0;
+	for (i = 0; i < NR_CONFIG_OPTIONS; i++)
+		cfg->unbind_prio[i] = SIZE_MAX;
+
+	for (ent = cfg->entries, prio = 0; ent; ent = ent->next, prio++) {
+		const char *tok;
+		char buf[sizeof ent->value];
+		int idx = 1;
+
+		if (ent->type != OPT_KEY && ent->type != OPT_BUTTON)
+			continue;
+
+		if (!strcmp(ent->value, "unbind")) {
+			if (cfg->unbind_prio[ent->option] == SIZE_MAX)
+				cfg->unbind_prio[ent->option] = prio;
+			continue;
+		}
+
+		strcpy(buf, ent->value);
+		for (tok = strtok(buf, " "); tok; tok = strtok(NULL, " "), idx++) {
+			struct input_event ev = {0};
+			struct binding *b;
+
+			if (input_parse_string(&ev, tok) || !ev.code)
+				continue;
 
-	struct config_entry *ent = config;
+			if (cfg->nr_bindings == MAX_BINDINGS) {
+				fprintf(stderr, "ERROR: too many key bindings, ignoring %s\n", tok);
+				break;
+			}
+
+			b = &cfg->bindings[cfg->nr_bindings++];
+
+			b->code = ev.code;
+			b->mods = ev.mods & 0xF;
+			b->idx = idx;
+			b->option = ent->option;
+			b->type = ent->type;
+			b->prio = prio;
+		}
+	}
+}
+
+static void free_config(struct config *cfg)
+{
+	struct config_entry *ent;
+
+	if (!cfg)
+		return;
+
+	ent = cfg->entries;
 	while (ent) {
 		struct config_entry *tmp = ent;
 		ent = ent->next;
 		free(tmp);
 	}
-	config = NULL;
+
+	free(cfg);
+}
+
+static uint64_t whitelist[(NR_CONFIG_OPTIONS + 63) / 64];
+
+static struct {
+	uint8_t idx; /* 0 if unbound. */
+	uint8_t option;
+	uint16_t binding;
+} keytable[256][16];
+
+static uint8_t cached_mods[256];
+
+static int whitelisted(uint8_t option)
+{
+	return !!(whitelist[option / 64] & ((uint64_t)1 << (option % 64)));
+}
+
+static void compile_keytable()
+{
+	size_t i;
+
+	memset(keytable, 0, sizeof keytable);
+
+	for (i = 0; i < config->nr_bindings; i++) {
+		int mods;
+		struct binding *b = &config->bindings[i];
+
+		if (!whitelisted(b->option))
+			continue;
+
+		/* Buttons match irrespective of the active modifiers. */
+		for (mods = 0; mods < 16; mods++) {
+			if (b->type == OPT_KEY && mods != b->mods)
+				continue;
+
+			if (!keytable[b->code][mods].idx) {
+				keytable[b->code][mods].idx = b->idx;
+				keytable[b->code][mods].option = b->option;
+				keytable[b->code][mods].binding = i;
+			}
+		}
+	}
+}
+
+/* Restrict matching to the supplied options (or all of them if options is NULL). */
+void config_input_whitelist(const enum config_option options[], size_t n)
+{
+	size_t i;
+
+	if (options == NULL) {
+		memset(whitelist, 0xFF, sizeof whitelist);
+	} else {
+		memset(whitelist, 0, sizeof whitelist);
+
+		for (i = 0; i < n; i++)
+			whitelist[options[i] / 64] |= (uint64_t)1 << (options[i] % 64);
+	}
+
+	compile_keytable();
+}
+
+void parse_config(const char *path)
+{
+	size_t i;
+	struct config *cfg;
+
+	FILE *fh = (path[0] == '-' && path[1] == 0) ? stdin : fopen(path, "r");
+
+	cfg = calloc(1, sizeof(struct config));
 
 	for (i = 0; i < sizeof(options) / sizeof(options[0]); i++)
-		config_add(options[i].key, options[i].val);
+		config_add(cfg, options[i].key, options[i].val);
 
 	if (fh) {
 		char line[1024];
@@ -252,93 +368,89 @@ void parse_config(const char *path)
 
 			delim[len] = 0;
 
-			config_add(line, delim);
+			config_add(cfg, line, delim);
 		}
 
 		fclose(fh);
 	}
-}
 
-static int keyidx(const char *key_list, struct input_event *ev, int *exact)
-{
-	const char *tok;
-	char buf[1024];
-	int idx = 1;
+	compile_bindings(cfg);
 
-	snprintf(buf, sizeof buf, "%s", key_list);
-
-	for (tok = strtok(buf, " "); tok; tok = strtok(NULL, " ")) {
-		int ret;
-		if ((ret = input_eq(ev, tok))) {
-			*exact = ret == 2;
-			return idx;
-		}
-
-		idx++;
+	memset(changed, 0, sizeof changed);
+	for (i = 0; i < NR_CONFIG_OPTIONS; i++) {
+		if (!config || strcmp(config->values[i].str, cfg->values[i].str))
+			changed[i / 64] |= (uint64_t)1 << (i % 64);
 	}
 
-	return 0;
+	free_config(config);
+	config = cfg;
+
+	config_input_whitelist(NULL, 0);
 }
 
-void config_input_whitelist(const char *names[], size_t n)
+void config_keymap_changed()
 {
-	struct config_entry *ent;
+	if (!config)
+		return;
 
-	for (ent = config; ent; ent = ent->next) {
-		ent->whitelisted = 0;
+	compile_bindings(config);
+	compile_keytable();
+	keymap_serial++;
+}
 
-		if (ent->type != OPT_KEY && ent->type != OPT_BUTTON)
-			continue;
+/*
+ * Anything else resolved from key names (e.g activation events) must be
+ * re-resolved once this changes.
+ */
+int config_keymap_serial()
+{
+	return keymap_serial;
+}
 
-		if (names == NULL) {
-			ent->whitelisted = 1;
-		} else {
-			size_t i;
+/*
+ * Returns 1 if any of the supplied options changed value during the last
+ * call to parse_config().
+ */
+int config_changed(const enum config_option options[], size_t n)
+{
+	size_t i;
 
-			for (i = 0; i < n; i++)
-				if (!strcmp(names[i], ent->key)) {
-					ent->whitelisted = 1;
-					break;
-				}
-		}
-	}
+	for (i = 0; i < n; i++)
+		if (changed[options[i] / 64] & ((uint64_t)1 << (options[i] % 64)))
+			return 1;
+
+	return 0;
 }
 
 /*
- * Consumes an input event and the name of a config option corresponding
- * to a set of keys and returns the 1-based index of the most recent
- * matching key (if any). The supplied config_key may be shadowed by
- * another key with the same option_type as the supplied key (in which
- * case this function will return 0).
-
- * NOTE: This is horribly inefficient (albeit fast enough). A better solution
- * would be to consume the event and type and return the corresponding
- * option for subsequent matching, but that would require
- * modifying all calling code.
+ * Consumes an input event and a config option corresponding to a set of keys
+ * and returns the 1-based index of the most recent matching key (if any). The
+ * supplied option may be shadowed by another key with the same option_type as
+ * the supplied key (in which case this function will return 0).
  */
-
-int config_input_match(struct input_event *ev, const char *config_key)
+int config_input_match(struct input_event *ev, enum config_option option)
 {
-	struct config_entry *ent;
+	uint8_t mods;
 
-	for (ent = config; ent; ent = ent->next) {
-		int idx;
-		int exact;
+	if (!ev)
+		return 0;
 
-		if (!strcmp(ent->key, config_key) && !strcmp(ent->value, "unbind"))
-			return 0;
+	/*
+	 * Cache mods on key down so we can properly detect the
+	 * corresponding key up event in the case of intermittent
+	 * modifier changes.
+	 */
+	if (ev->pressed)
+		cached_mods[ev->code] = ev->mods;
 
-		if (ent->whitelisted && (idx = keyidx(ent->value, ev, &exact))) {
-			if ((ent->type == OPT_KEY && exact) || ent->type == OPT_BUTTON) {
-				if (!strcmp(ent->key, config_key))
-					return idx;
-				else
-					return 0;
-			}
-		}
-	}
+	mods = cached_mods[ev->code] & 0xF;
 
-	return 0;
+	if (!keytable[ev->code][mods].idx ||
+	    keytable[ev->code][mods].option != option ||
+	    config->bindings[keytable[ev->code][mods].binding].prio > config->unbind_prio[option])
+		return 0;
+
+	return keytable[ev->code][mods].idx;
 }
 
 void config_print_options()
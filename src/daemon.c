@@ -1,72 +1,139 @@
 #include "warpd.h"
-static const char *activation_keys[] = {
-	"activation_key",
-	"hint_activation_key",
-	"grid_activation_key",
-	"hint_oneshot_key",
-	"screen_activation_key",
-	"hint2_activation_key",
-	"hint2_oneshot_key",
-	"history_activation_key",
+static const enum config_option activation_keys[] = {
+	CFG_ACTIVATION_KEY,
+	CFG_HINT_ACTIVATION_KEY,
+	CFG_GRID_ACTIVATION_KEY,
+	CFG_HINT_ONESHOT_KEY,
+	CFG_SCREEN_ACTIVATION_KEY,
+	CFG_HINT2_ACTIVATION_KEY,
+	CFG_HINT2_ONESHOT_KEY,
+	CFG_HISTORY_ACTIVATION_KEY,
+};
+
+/* Options consumed by init_hints() and prerender_hints(). */
+static const enum config_option hint_options[] = {
+	CFG_HINT_BGCOLOR,
+	CFG_HINT_FGCOLOR,
+	CFG_HINT_BORDER_RADIUS,
+	CFG_HINT_FONT,
+	CFG_HINT_CHARS,
+	CFG_HINT_SIZE,
+};
+
+/* Options consumed by init_mouse(). */
+static const enum config_option mouse_options[] = {
+	CFG_CURSOR_SIZE,
+	CFG_SPEED,
+	CFG_MAX_SPEED,
+	CFG_DECELERATOR_SPEED,
+	CFG_ACCELERATION,
+	CFG_ACCELERATOR_ACCELERATION,
 };
 
 static struct input_event activation_events[sizeof activation_keys / sizeof activation_keys[0]];
 
+static void init_activation_events()
+{
+	size_t i;
+
+	for (i = 0; i < sizeof activation_keys / sizeof activation_keys[0]; i++)
+		input_parse_string(&activation_events[i], config_get(activation_keys[i]));
+}
+
+/*
+ * Only reinitialize the subsystems affected by the change, since
+ * reinitializing hints discards any cached hint renderings. Everything
+ * else reads the config directly.
+ */
 static void reload_config(const char *path)
 {
-	int i;
+	static int nr_reloads = 0;
+	uint64_t start = get_time_us();
 
 	parse_config(path);
 
-	init_hints();
-	init_mouse();
+	if (config_changed(hint_options, sizeof hint_options / sizeof hint_options[0])) {
+		init_hints();
+		prerender_hints();
+	}
 
-	for (i = 0; i < sizeof activation_keys / sizeof activation_keys[0]; i++)
-		input_parse_string(&activation_events[i], config_get(activation_keys[i]));
+	if (config_changed(mouse_options, sizeof mouse_options / sizeof mouse_options[0]))
+		init_mouse();
+
+	if (config_changed(activation_keys, sizeof activation_keys / sizeof activation_keys[0]))
+		init_activation_events();
 
+	nr_reloads++;
+	printf("Reloaded config (%d) in %lu us\n", nr_reloads,
+	       (unsigned long)(get_time_us() - start));
 }
 
+/* Expects the config to have been loaded by the caller. */
 void daemon_loop(const char *config_path)
 {
-	size_t i;
-
+	int ipc_fd = -1;
+	int keymap_serial = config_keymap_serial();
 
 	platform->monitor_file(config_path);
-	reload_config(config_path);
+	init_activation_events();
+
+	/*
+	 * Wayland is deliberately out of scope: it has no daemon at all
+	 * (input_wait can't be implemented there), so oneshot invocations
+	 * always run locally. macOS and Windows don't implement monitor_fd
+	 * yet.
+	 */
+	if (platform->monitor_fd && (ipc_fd = ipc_listen(config_path)) >= 0)
+		platform->monitor_fd(ipc_fd);
 
 	while (1) {
 		int mode = 0;
-		struct input_event *ev = platform->input_wait(activation_events,
-							     sizeof(activation_events) /
-							     sizeof(activation_events[0]));
+		struct input_event *ev;
+
+		/* e.g a layout change, the activation keys may now have different codes. */
+		if (keymap_serial != config_keymap_serial()) {
+			keymap_serial = config_keymap_serial();
+			init_activation_events();
+		}
+
+		ev = platform->input_wait(activation_events,
+					  sizeof(activation_events) /
+					  sizeof(activation_events[0]));
 
 		if (!ev) {
-			reload_config(config_path);
+			if (keymap_serial != config_keymap_serial())
+				continue;
+
+			if (ipc_fd < 0 || !ipc_serve(ipc_fd))
+				reload_config(config_path);
 			continue;
 		}
 
 		config_input_whitelist(activation_keys, sizeof activation_keys / sizeof activation_keys[0]);
 
-		if (config_input_match(ev, "activation_key"))
+		if (config_input_match(ev, CFG_ACTIVATION_KEY))
 			mode = MODE_NORMAL;
-		else if (config_input_match(ev, "grid_activation_key"))
+		else if (config_input_match(ev, CFG_GRID_ACTIVATION_KEY))
 			mode = MODE_GRID;
-		else if (config_input_match(ev, "hint_activation_key"))
+		else if (config_input_match(ev, CFG_HINT_ACTIVATION_KEY))
 			mode = MODE_HINT;
-		else if (config_input_match(ev, "hint2_activation_key"))
+		else if (config_input_match(ev, CFG_HINT2_ACTIVATION_KEY))
 			mode = MODE_HINT2;
-		else if (config_input_match(ev, "screen_activation_key"))
+		else if (config_input_match(ev, CFG_SCREEN_ACTIVATION_KEY))
 			mode = MODE_SCREEN_SELECTION;
-		else if (config_input_match(ev, "history_activation_key"))
+		else if (config_input_match(ev, CFG_HISTORY_ACTIVATION_KEY))
 			mode = MODE_HISTORY;
-		else if (config_input_match(ev, "hint2_oneshot_key")) {
+		else if (config_input_match(ev, CFG_HINT2_ONESHOT_KEY)) {
+			session_begin();
+			session_set_mode(MODE_HINT2);
 			full_hint_mode(1);
+			session_end();
 			continue;
-		} else if (config_input_match(ev, "hint_oneshot_key")) {
+		} else if (config_input_match(ev, CFG_HINT_ONESHOT_KEY)) {
+			session_begin();
+			session_set_mode(MODE_HINT);
 			full_hint_mode(0);
-			continue;
-		} else if (config_input_match(ev, "history_oneshot_key")) {
-			history_hint_mode();
+			session_end();
 			continue;
 		}
 
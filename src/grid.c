@@ -11,7 +11,7 @@ static int grid_height;
 static screen_t scr;
 
 static void draw_grid(screen_t scr,
-		      const char *color, int sz,
+		      uint32_t color, int sz,
 		      int nc, int nr,
 		      int x, int y, int w, int h)
 {
@@ -35,13 +35,13 @@ static void redraw(int mx, int my, int force)
 	const int x = mx - grid_width/2;
 	const int y = my - grid_height/2;
 
-	const int nc = config_get_int("grid_nc");
-	const int nr = config_get_int("grid_nr");
-	const int cursz = config_get_int("cursor_size");
-	const int gsz = config_get_int("grid_size");
-	const int gbsz = config_get_int("grid_border_size");
-	const char *gbcol = config_get("grid_border_color");
-	const char *gcol = config_get("grid_color");
+	const int nc = config_get_int(CFG_GRID_NC);
+	const int nr = config_get_int(CFG_GRID_NR);
+	const int cursz = config_get_int(CFG_CURSOR_SIZE);
+	const int gsz = config_get_int(CFG_GRID_SIZE);
+	const int gbsz = config_get_int(CFG_GRID_BORDER_SIZE);
+	const uint32_t gbcol = config_get_color(CFG_GRID_BORDER_COLOR);
+	const uint32_t gcol = config_get_color(CFG_GRID_COLOR);
 
 	const int gh = grid_height;
 	const int gw = grid_width;
@@ -72,7 +72,7 @@ static void redraw(int mx, int my, int force)
 	platform->screen_draw_box(scr,
 			x+gw/2-cursz/2, y+gh/2-cursz/2,
 			cursz, cursz,
-			config_get("cursor_color"));
+			config_get_color(CFG_CURSOR_COLOR));
 
 	platform->commit();
 }
@@ -83,11 +83,12 @@ struct input_event *grid_mode()
 	int mx, my;
 	struct input_event *ev;
 
-	const int nc = config_get_int("grid_nc");
-	const int nr = config_get_int("grid_nr");
+	/* Set if the pointer has moved since the grid was last drawn. */
+	int dirty = 0;
+
+	const int nc = config_get_int(CFG_GRID_NC);
+	const int nr = config_get_int(CFG_GRID_NR);
 
-	platform->input_grab_keyboard();
-	platform->mouse_hide();
 	mouse_reset();
 
 	platform->mouse_get_position(&scr, NULL, NULL);
@@ -98,37 +99,57 @@ struct input_event *grid_mode()
 	platform->mouse_move(scr, mx, my);
 	redraw(mx, my, 1);
 
-	const char *keys[] = {
-		"grid_up",
-		"grid_down",
-		"grid_right",
-		"grid_left",
-		"grid_cut_up",
-		"grid_cut_down",
-		"grid_cut_right",
-		"grid_cut_left",
-		"grid_keys",
-
-		"buttons",
-		"oneshot_buttons",
-
-		"grid",
-		"hint",
-		"exit",
-		"drag",
-		"grid_exit",
+	const enum config_option keys[] = {
+		CFG_GRID_UP,
+		CFG_GRID_DOWN,
+		CFG_GRID_RIGHT,
+		CFG_GRID_LEFT,
+		CFG_GRID_CUT_UP,
+		CFG_GRID_CUT_DOWN,
+		CFG_GRID_CUT_RIGHT,
+		CFG_GRID_CUT_LEFT,
+		CFG_GRID_KEYS,
+
+		CFG_BUTTONS,
+		CFG_ONESHOT_BUTTONS,
+
+		CFG_GRID,
+		CFG_HINT,
+		CFG_EXIT,
+		CFG_DRAG,
+		CFG_GRID_EXIT,
 	};
 
 	config_input_whitelist(keys, sizeof keys / sizeof keys[0]);
 
 	while (1) {
 		int idx;
+		int moved;
+
+		/* A burst of motion keys is drawn once, after the last of them. */
+		if (dirty && !input_pending()) {
+			redraw(mx, my, 0);
+			dirty = 0;
+		}
+
+		/* Only tick while the pointer is moving. */
+		if (!mouse_moving())
+			timer_clear(TIMER_FRAME);
+		else if (!timer_armed(TIMER_FRAME))
+			timer_next_frame(scr);
 
-		ev = platform->input_next_event(10);
+		ev = timer_next_event();
+
+		if (timer_expired(TIMER_FRAME))
+			timer_next_frame(scr);
+
+		moved = mouse_process_key(ev, CFG_GRID_UP, CFG_GRID_DOWN, CFG_GRID_LEFT, CFG_GRID_RIGHT);
+
+		/* Read after the motion update so the grid doesn't lag a frame behind. */
 		platform->mouse_get_position(NULL, &mx, &my);
 
-		if (mouse_process_key(ev, "grid_up", "grid_down", "grid_left", "grid_right")) {
-			redraw(mx, my, 0);
+		if (moved) {
+			dirty = 1;
 			continue;
 		}
 
@@ -136,7 +157,7 @@ struct input_event *grid_mode()
 		if (!ev || !ev->pressed)
 			continue;
 
-		if ((idx = config_input_match(ev, "grid_keys")) && idx <= nc * nr) {
+		if ((idx = config_input_match(ev, CFG_GRID_KEYS)) && idx <= nc * nr) {
 			my = (my - grid_height / 2) + (grid_height / nr) * ((idx-1) / nc);
 			mx = (mx - grid_width / 2) + (grid_width / nc) * ((idx-1) % nc);
 
@@ -149,7 +170,7 @@ struct input_event *grid_mode()
 			redraw(mx, my, 0);
 		}
 
-		if (config_input_match(ev, "grid_cut_up")) {
+		if (config_input_match(ev, CFG_GRID_CUT_UP)) {
 			my -= grid_height/4;
 			grid_height /= 2;
 
@@ -157,7 +178,7 @@ struct input_event *grid_mode()
 			redraw(mx, my, 0);
 		}
 
-		if (config_input_match(ev, "grid_cut_down")) {
+		if (config_input_match(ev, CFG_GRID_CUT_DOWN)) {
 			my += grid_height/4;
 			grid_height /= 2;
 
@@ -165,7 +186,7 @@ struct input_event *grid_mode()
 			redraw(mx, my, 0);
 		}
 
-		if (config_input_match(ev, "grid_cut_left")) {
+		if (config_input_match(ev, CFG_GRID_CUT_LEFT)) {
 			mx -= grid_width/4;
 			grid_width /= 2;
 
@@ -173,7 +194,7 @@ struct input_event *grid_mode()
 			redraw(mx, my, 0);
 		}
 
-		if (config_input_match(ev, "grid_cut_right")) {
+		if (config_input_match(ev, CFG_GRID_CUT_RIGHT)) {
 			mx += grid_width/4;
 			grid_width /= 2;
 
@@ -181,27 +202,25 @@ struct input_event *grid_mode()
 			redraw(mx, my, 0);
 		}
 
-		if (config_input_match(ev, "buttons") ||
-			config_input_match(ev, "oneshot_buttons")) {
+		if (config_input_match(ev, CFG_BUTTONS) ||
+			config_input_match(ev, CFG_ONESHOT_BUTTONS)) {
 			goto exit;
 		}
 
-		if (config_input_match(ev, "grid") ||
-		    config_input_match(ev, "hint") ||
-		    config_input_match(ev, "exit") ||
-		    config_input_match(ev, "drag") ||
-		    config_input_match(ev, "grid_exit"))
+		if (config_input_match(ev, CFG_GRID) ||
+		    config_input_match(ev, CFG_HINT) ||
+		    config_input_match(ev, CFG_EXIT) ||
+		    config_input_match(ev, CFG_DRAG) ||
+		    config_input_match(ev, CFG_GRID_EXIT))
 			goto exit;
 
 		redraw(mx, my, 0);
 	}
 
 exit:
+	timer_clear(TIMER_FRAME);
 	config_input_whitelist(NULL, 0);
 	platform->screen_clear(scr);
-	platform->mouse_show();
-
-	platform->input_ungrab_keyboard();
 
 	platform->commit();
 	return ev;
@@ -6,26 +6,91 @@
 
 #include "warpd.h"
 
-struct hint *hints;
-struct hint matched[MAX_HINTS];
+/*
+ * Hints are sorted by label at the start of each selection so the hints
+ * sharing any given prefix form a contiguous range. ranges[n] holds the
+ * range matching the first n characters of the input, so a keystroke just
+ * narrows the current range and undo drops back a level.
+ */
+struct range {
+	size_t start;
+	size_t end;
+};
 
+static struct hint *hints;
 static size_t nr_hints;
-static size_t nr_matched;
+
+static struct range ranges[sizeof hints->label + 1];
+static size_t depth;
+
+/* The range currently on screen. */
+static struct range drawn;
 
 char last_selected_hint[32];
 
-static void filter(screen_t scr, const char *s)
+static int label_cmp(const void *a, const void *b)
 {
-	size_t i;
+	return strcmp(((const struct hint *)a)->label, ((const struct hint *)b)->label);
+}
 
-	nr_matched = 0;
-	for (i = 0; i < nr_hints; i++) {
-		if (strstr(hints[i].label, s) == hints[i].label)
-			matched[nr_matched++] = hints[i];
+/* Narrows the current range to the hints with c at position depth. */
+static void narrow(char c)
+{
+	const unsigned char uc = c;
+	size_t lo = ranges[depth].start;
+	size_t hi = ranges[depth].end;
+	size_t start;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if ((unsigned char)hints[mid].label[depth] < uc)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	platform->screen_clear(scr);
-	platform->hint_draw(scr, matched, nr_matched);
+	start = lo;
+	hi = ranges[depth].end;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if ((unsigned char)hints[mid].label[depth] <= uc)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	depth++;
+	ranges[depth].start = start;
+	ranges[depth].end = lo;
+}
+
+static size_t nr_matched()
+{
+	return ranges[depth].end - ranges[depth].start;
+}
+
+static void filter(screen_t scr)
+{
+	struct range *r = &ranges[depth];
+
+	/* If we narrowed the drawn set, only erase the eliminated hints. */
+	if (platform->hint_update &&
+	    r->start >= drawn.start && r->end <= drawn.end) {
+		if (r->start > drawn.start)
+			platform->hint_update(scr, hints + drawn.start,
+					      r->start - drawn.start);
+		if (drawn.end > r->end)
+			platform->hint_update(scr, hints + r->end,
+					      drawn.end - r->end);
+	} else {
+		platform->screen_clear(scr);
+		platform->hint_draw(scr, hints + r->start, nr_matched());
+	}
+
+	drawn = *r;
 	platform->commit();
 }
 
@@ -41,8 +106,8 @@ static void get_hint_size(screen_t scr, int *w, int *h)
 		sh = tmp;
 	}
 
-	*w = (sw * config_get_int("hint_size")) / 1000;
-	*h = (sh * config_get_int("hint_size")) / 1000;
+	*w = (sw * config_get_int(CFG_HINT_SIZE)) / 1000;
+	*h = (sh * config_get_int(CFG_HINT_SIZE)) / 1000;
 }
 
 static size_t generate_fullscreen_hints(screen_t scr, struct hint *hints)
@@ -52,7 +117,7 @@ static size_t generate_fullscreen_hints(screen_t scr, struct hint *hints)
 	int i, j;
 	size_t n = 0;
 
-	const char *chars = config_get("hint_chars");
+	const char *chars = config_get(CFG_HINT_CHARS);
 	get_hint_size(scr, &w, &h);
 	platform->screen_get_dimensions(scr, &sw, &sh);
 
@@ -100,55 +165,60 @@ static int hint_selection(screen_t scr, struct hint *_hints, size_t _nr_hints)
 	hints = _hints;
 	nr_hints = _nr_hints;
 
-	filter(scr, "");
+	qsort(hints, nr_hints, sizeof hints[0], label_cmp);
+
+	depth = 0;
+	ranges[0].start = 0;
+	ranges[0].end = nr_hints;
+
+	drawn.start = 0;
+	drawn.end = 0;
+
+	filter(scr);
 
 	int rc = 0;
 	char buf[32] = {0};
-	platform->input_grab_keyboard();
 
-	platform->mouse_hide();
-
-	const char *keys[] = {
-		"hint_exit",
-		"hint_undo_all",
-		"hint_undo",
+	const enum config_option keys[] = {
+		CFG_HINT_EXIT,
+		CFG_HINT_UNDO_ALL,
+		CFG_HINT_UNDO,
 	};
 
 	config_input_whitelist(keys, sizeof keys / sizeof keys[0]);
 
 	while (1) {
 		struct input_event *ev;
-		ssize_t len;
 
-		ev = platform->input_next_event(0);
+		ev = input_next_event(0);
 
 		if (!ev->pressed)
 			continue;
 
-		len = strlen(buf);
-
-		if (config_input_match(ev, "hint_exit")) {
+		if (config_input_match(ev, CFG_HINT_EXIT)) {
 			rc = -1;
 			break;
-		} else if (config_input_match(ev, "hint_undo_all")) {
-			buf[0] = 0;
-		} else if (config_input_match(ev, "hint_undo")) {
-			if (len)
-				buf[len - 1] = 0;
+		} else if (config_input_match(ev, CFG_HINT_UNDO_ALL)) {
+			depth = 0;
+		} else if (config_input_match(ev, CFG_HINT_UNDO)) {
+			if (depth)
+				depth--;
 		} else {
 			const char *name = input_event_tostr(ev);
 
 			if (!name || name[1])
 				continue;
 
-			buf[len++] = name[0];
+			buf[depth] = name[0];
+			narrow(name[0]);
 		}
 
-		filter(scr, buf);
+		buf[depth] = 0;
+		filter(scr);
 
-		if (nr_matched == 1) {
+		if (nr_matched() == 1) {
 			int nx, ny;
-			struct hint *h = &matched[0];
+			struct hint *h = &hints[ranges[depth].start];
 
 			platform->screen_clear(scr);
 
@@ -165,14 +235,12 @@ static int hint_selection(screen_t scr, struct hint *_hints, size_t _nr_hints)
 			platform->mouse_move(scr, nx, ny);
 			strcpy(last_selected_hint, buf);
 			break;
-		} else if (nr_matched == 0) {
+		} else if (nr_matched() == 0) {
 			break;
 		}
 	}
 
-	platform->input_ungrab_keyboard();
 	platform->screen_clear(scr);
-	platform->mouse_show();
 
 	platform->commit();
 	return rc;
@@ -180,13 +248,13 @@ static int hint_selection(screen_t scr, struct hint *_hints, size_t _nr_hints)
 
 static int sift()
 {
-	int gap = config_get_int("hint2_gap_size");
-	int hint_sz = config_get_int("hint2_size");
+	int gap = config_get_int(CFG_HINT2_GAP_SIZE);
+	int hint_sz = config_get_int(CFG_HINT2_SIZE);
 
-	const char *chars = config_get("hint2_chars");
+	const char *chars = config_get(CFG_HINT2_CHARS);
 	size_t chars_len= strlen(chars);
 
-	int grid_sz = config_get_int("hint2_grid_size");
+	int grid_sz = config_get_int(CFG_HINT2_GRID_SIZE);
 
 	int x, y;
 	int sh, sw;
@@ -229,10 +297,30 @@ static int sift()
 
 void init_hints()
 {
-	platform->init_hint(config_get("hint_bgcolor"),
-			    config_get("hint_fgcolor"),
-			    config_get_int("hint_border_radius"),
-			    config_get("hint_font"));
+	platform->init_hint(config_get_color(CFG_HINT_BGCOLOR),
+			    config_get_color(CFG_HINT_FGCOLOR),
+			    config_get_int(CFG_HINT_BORDER_RADIUS),
+			    config_get(CFG_HINT_FONT));
+}
+
+/*
+ * Renders the fullscreen hints of every screen ahead of time, so the first
+ * activation doesn't pay for it. Only worthwhile in the daemon, a oneshot
+ * process (e.g --move) may never draw a hint.
+ */
+void prerender_hints()
+{
+	size_t i, n;
+	screen_t screens[MAX_SCREENS];
+	struct hint hints[MAX_HINTS];
+
+	if (!platform->hint_prerender)
+		return;
+
+	platform->screen_list(screens, &n);
+	for (i = 0; i < n; i++)
+		platform->hint_prerender(screens[i], hints,
+					 generate_fullscreen_hints(screens[i], hints));
 }
 
 int hintspec_mode()
@@ -249,7 +337,18 @@ int hintspec_mode()
 
 	get_hint_size(scr, &w, &h);
 
-	while (scanf("%15s %d %d",
+	/*
+	 * Use a private stream so nothing is left buffered in stdin between
+	 * requests when run by the daemon on behalf of a client.
+	 */
+	FILE *fh = fdopen(dup(0), "r");
+
+	if (!fh) {
+		perror("fdopen");
+		return -1;
+	}
+
+	while (n < MAX_HINTS && fscanf(fh, "%15s %d %d",
 		hints[n].label,
 		&hints[n].x,
 		&hints[n].y) == 3) {
@@ -262,6 +361,8 @@ int hintspec_mode()
 		n++;
 	}
 
+	fclose(fh);
+
 	return hint_selection(scr, hints, n);
 }
 
@@ -11,7 +11,46 @@
 
 #include "warpd.h"
 
-static uint8_t cached_mods[256];
+#define INPUT_BATCH_SZ 64
+
+/* Events read by the last input_next_events call, yet to be handed out. */
+static struct input_event batch[INPUT_BATCH_SZ];
+static size_t batch_pos;
+static size_t batch_len;
+
+/*
+ * Returns the next input event, or NULL on timeout (see
+ * platform->input_next_event). Where the platform supports it, pending
+ * events are read in batches, and input_pending() lets the caller skip
+ * work (e.g redrawing) which the rest of the batch would supersede.
+ */
+struct input_event *input_next_event(int timeout)
+{
+	if (!platform->input_next_events)
+		return platform->input_next_event(timeout);
+
+	if (batch_pos == batch_len) {
+		batch_pos = 0;
+		batch_len = platform->input_next_events(batch, INPUT_BATCH_SZ, timeout);
+
+		if (!batch_len)
+			return NULL;
+	}
+
+	return &batch[batch_pos++];
+}
+
+/* Returns the number of events which have been read but not handed out. */
+size_t input_pending()
+{
+	return batch_len - batch_pos;
+}
+
+/* Discards any events left over from the last batch (e.g on session end). */
+void input_flush()
+{
+	batch_pos = batch_len = 0;
+}
 
 int input_parse_string(struct input_event *ev, const char *s)
 {
@@ -85,40 +124,3 @@ const char *input_event_tostr(struct input_event *ev)
 
 	return s;
 }
-
-/*
- * Returns:
- * 0 on no match
- * 1 on code match
- * 2 on full match
- */
-int input_eq(struct input_event *ev, const char *str)
-{
-	uint8_t mods;
-	struct input_event ev1;
-
-	if (!ev)
-		return 0;
-
-	/*
-	 * Cache mods on key down so we can properly detect the
-	 * corresponding key up event in the case of intermittent
-	 * modifier changes.
-	 */
-	if (ev->pressed) {
-		mods = ev->mods;
-		cached_mods[ev->code] = ev->mods;
-	} else {
-		mods = cached_mods[ev->code];
-	}
-
-	if (input_parse_string(&ev1, str) < 0)
-		return 0;
-
-	if (ev1.code != ev->code)
-		return 0;
-	else if (ev1.mods != mods)
-		return 1;
-	else
-		return 2;
-}
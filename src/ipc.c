@@ -0,0 +1,412 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * Control socket used by oneshot invocations (--hint --oneshot, --move,
+ * --click, -q, etc) to have an already running daemon perform the request
+ * instead of paying for a full platform/config/hint initialization each
+ * time.
+ *
+ * Protocol:
+ *
+ *	client: struct oneshot_request
+ *	daemon: 1 byte ack (1 if the request is accepted, 0 if the client
+ *		should run it itself)
+ *	client: 1 byte go (confirms the client hasn't given up on the daemon)
+ *	client: [stdin contents until EOF] (MODE_HINTSPEC only)
+ *	daemon: program output (what would have been printed to stdout)
+ *	daemon: int exit code
+ *
+ * The socket lives in $XDG_RUNTIME_DIR, which only its owner can write to
+ * (without it there is no daemon IPC). Each side also checks that the
+ * other runs as the same uid, so neither can be impersonated.
+ *
+ * Every read and write on a connection is subject to a timeout on the
+ * daemon side, so a stalled client can't wedge the daemon. The daemon only
+ * serves requests between sessions, so clients only wait briefly for the
+ * ack and otherwise run the request themselves. The go byte ensures the
+ * request is never run by both. Clients buffer any hintspec input before
+ * connecting so they never stall on their own stdin mid-request.
+ */
+
+/* struct ucred */
+#define _GNU_SOURCE
+
+#include "warpd.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/* Applies to each read/write on a client connection. */
+#define IPC_TIMEOUT_MS 1000
+
+/* How long a client waits for the daemon to pick up its request. */
+#define IPC_ACK_TIMEOUT_MS 200
+
+static char daemon_display[64];
+static char daemon_wayland_display[64];
+static char daemon_config_path[PATH_MAX];
+
+/*
+ * Returns NULL if XDG_RUNTIME_DIR isn't set. There is deliberately no
+ * fallback to a shared directory like /tmp, where another user could
+ * create the socket first.
+ */
+static const char *socket_path()
+{
+	static char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	const char *dir = getenv("XDG_RUNTIME_DIR");
+
+	if (!dir || !dir[0])
+		return NULL;
+
+	snprintf(path, sizeof path, "%s/warpd.sock", dir);
+	return path;
+}
+
+static void copy_env(char *dst, size_t sz, const char *name)
+{
+	const char *val = getenv(name);
+
+	snprintf(dst, sz, "%s", val ? val : "");
+}
+
+static int read_all(int fd, void *buf, size_t sz)
+{
+	size_t n = 0;
+
+	while (n < sz) {
+		ssize_t ret = read(fd, (char *)buf + n, sz - n);
+
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return -1;
+
+		n += ret;
+	}
+
+	return 0;
+}
+
+static int write_all(int fd, const void *buf, size_t sz)
+{
+	size_t n = 0;
+
+	while (n < sz) {
+		ssize_t ret = write(fd, (const char *)buf + n, sz - n);
+
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return -1;
+
+		n += ret;
+	}
+
+	return 0;
+}
+
+/* Returns 0 and stores the uid of the connected peer, or -1 on failure. */
+static int peer_uid(int fd, uid_t *uid)
+{
+#ifdef SO_PEERCRED
+	struct ucred cred;
+	socklen_t len = sizeof cred;
+
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len))
+		return -1;
+
+	*uid = cred.uid;
+	return 0;
+#else
+	gid_t gid;
+
+	return getpeereid(fd, uid, &gid);
+#endif
+}
+
+static void set_timeout(int fd, int opt, int ms)
+{
+	struct timeval tv = {ms / 1000, (ms % 1000) * 1000};
+
+	setsockopt(fd, SOL_SOCKET, opt, &tv, sizeof tv);
+}
+
+/* Returns a connection to a daemon running as our own uid, or -1. */
+static int connect_socket()
+{
+	int fd;
+	uid_t uid = -1;
+	struct sockaddr_un addr = {0};
+
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socket_path(), sizeof addr.sun_path - 1);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return -1;
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof addr)) {
+		close(fd);
+		return -1;
+	}
+
+	if (peer_uid(fd, &uid) || uid != getuid()) {
+		fprintf(stderr, "WARNING: %s is owned by uid %d, ignoring it\n",
+			socket_path(), (int)uid);
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/*
+ * Returns a listening socket or -1 if one could not be created, in which
+ * case oneshot invocations fall back to running locally. Must only be
+ * called by the process holding the instance lock.
+ */
+int ipc_listen(const char *config_path)
+{
+	int fd;
+	int ret;
+	mode_t mask;
+	struct sockaddr_un addr = {0};
+	const char *path = socket_path();
+
+	if (!path)
+		return -1;
+
+	copy_env(daemon_display, sizeof daemon_display, "DISPLAY");
+	copy_env(daemon_wayland_display, sizeof daemon_wayland_display, "WAYLAND_DISPLAY");
+	snprintf(daemon_config_path, sizeof daemon_config_path, "%s", config_path);
+
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof addr.sun_path - 1);
+
+	/* Clients which disconnect early shouldn't take the daemon down. */
+	signal(SIGPIPE, SIG_IGN);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		perror("socket");
+		return -1;
+	}
+
+	/*
+	 * The socket is created with the right permissions, a chmod() after
+	 * bind() would leave a window in which anyone could connect.
+	 */
+	unlink(path);
+	mask = umask(077);
+	ret = bind(fd, (struct sockaddr *)&addr, sizeof addr);
+	umask(mask);
+
+	if (ret || listen(fd, 8)) {
+		fprintf(stderr, "WARNING: Failed to create control socket %s: %s\n",
+			path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	return fd;
+}
+
+/*
+ * Services a single pending request on the listening socket.
+ * Returns 1 if a connection was accepted, 0 otherwise.
+ */
+int ipc_serve(int sock)
+{
+	int fd;
+	int rc;
+	int saved_stdin, saved_stdout;
+	uid_t uid = -1;
+	unsigned char ack, go;
+	struct oneshot_request req;
+
+	if ((fd = accept(sock, NULL, NULL)) < 0)
+		return 0;
+
+	/* The socket permissions should already ensure this. */
+	if (peer_uid(fd, &uid) || uid != getuid()) {
+		fprintf(stderr, "WARNING: Rejected control connection from uid %d\n", (int)uid);
+		goto exit;
+	}
+
+	/* Kept for the entire request, including oneshot_run(). */
+	set_timeout(fd, SO_RCVTIMEO, IPC_TIMEOUT_MS);
+	set_timeout(fd, SO_SNDTIMEO, IPC_TIMEOUT_MS);
+
+	if (read_all(fd, &req, sizeof req))
+		goto exit;
+
+	req.config_path[sizeof req.config_path - 1] = 0;
+	req.display[sizeof req.display - 1] = 0;
+	req.wayland_display[sizeof req.wayland_display - 1] = 0;
+
+	ack = !strcmp(req.config_path, daemon_config_path) &&
+	      !strcmp(req.display, daemon_display) &&
+	      !strcmp(req.wayland_display, daemon_wayland_display);
+
+	if (write_all(fd, &ack, 1) || !ack)
+		goto exit;
+
+	/* The client may have timed out and be running the request itself. */
+	if (read_all(fd, &go, 1) || !go)
+		goto exit;
+
+	fflush(stdout);
+	saved_stdin = dup(0);
+	saved_stdout = dup(1);
+	dup2(fd, 0);
+	dup2(fd, 1);
+
+	rc = oneshot_run(&req);
+
+	fflush(stdout);
+	dup2(saved_stdin, 0);
+	dup2(saved_stdout, 1);
+	close(saved_stdin);
+	close(saved_stdout);
+
+	write_all(fd, &rc, sizeof rc);
+
+exit:
+	close(fd);
+	return 1;
+}
+
+/* Reads stdin until EOF. */
+static char *read_input(size_t *sz)
+{
+	ssize_t n;
+	size_t cap = 4096;
+	char *buf = malloc(cap);
+
+	*sz = 0;
+	while ((n = read(0, buf + *sz, cap - *sz)) > 0 || (n < 0 && errno == EINTR)) {
+		if (n < 0)
+			continue;
+
+		*sz += n;
+		if (*sz == cap)
+			buf = realloc(buf, cap *= 2);
+	}
+
+	return buf;
+}
+
+/* Makes input consumed by read_input() available on stdin again. */
+static void restore_input(const char *buf, size_t sz)
+{
+	FILE *fh = tmpfile();
+
+	if (!fh) {
+		perror("tmpfile");
+		return;
+	}
+
+	fwrite(buf, 1, sz, fh);
+	fflush(fh);
+	lseek(fileno(fh), 0, SEEK_SET);
+	dup2(fileno(fh), 0);
+	fclose(fh);
+}
+
+/*
+ * Forwards the request to a running daemon. Returns 0 and stores the
+ * exit code in rc on success, or -1 if the request should be run locally.
+ */
+int ipc_request(struct oneshot_request *req, const char *config_path, int *rc)
+{
+	int fd;
+	ssize_t n;
+	unsigned char ack;
+	const unsigned char go = 1;
+	char buf[4096 + sizeof(int)];
+	size_t held = 0;
+	char *input = NULL;
+	size_t input_sz = 0;
+
+	/* The daemon can't read a config from our stdin. */
+	if (!strcmp(config_path, "-"))
+		return -1;
+
+	if (!socket_path() || access(socket_path(), F_OK))
+		return -1;
+
+	/* Read ahead, the daemon mustn't wait on whatever feeds our stdin. */
+	if (req->mode == MODE_HINTSPEC)
+		input = read_input(&input_sz);
+
+	snprintf(req->config_path, sizeof req->config_path, "%s", config_path);
+	copy_env(req->display, sizeof req->display, "DISPLAY");
+	copy_env(req->wayland_display, sizeof req->wayland_display, "WAYLAND_DISPLAY");
+
+	if ((fd = connect_socket()) >= 0)
+		set_timeout(fd, SO_RCVTIMEO, IPC_ACK_TIMEOUT_MS);
+
+	/* e.g the daemon is busy with a session and can't serve us yet. */
+	if (fd < 0 ||
+	    write_all(fd, req, sizeof *req) ||
+	    read_all(fd, &ack, 1) || !ack ||
+	    write_all(fd, &go, 1)) {
+		if (fd >= 0)
+			close(fd);
+
+		if (input)
+			restore_input(input, input_sz);
+
+		free(input);
+		return -1;
+	}
+
+	/* The request itself may take arbitrarily long (e.g hint selection). */
+	set_timeout(fd, SO_RCVTIMEO, 0);
+
+	if (input)
+		write_all(fd, input, input_sz);
+
+	free(input);
+	shutdown(fd, SHUT_WR);
+
+	/*
+	 * Stream the output through as it arrives, holding back the trailing
+	 * exit code.
+	 */
+	while (1) {
+		n = read(fd, buf + held, sizeof buf - held);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+
+		held += n;
+		if (held > sizeof(int)) {
+			write_all(1, buf, held - sizeof(int));
+			memmove(buf, buf + held - sizeof(int), sizeof(int));
+			held = sizeof(int);
+		}
+	}
+
+	close(fd);
+
+	if (held != sizeof(int)) {
+		fprintf(stderr, "ERROR: Lost connection to the warpd daemon.\n");
+		*rc = -1;
+	} else {
+		memcpy(rc, buf, sizeof(int));
+	}
+
+	return 0;
+}
@@ -1,14 +1,74 @@
 #include "warpd.h"
 
+/*
+ * A session spans every mode entered from a single activation. The keyboard
+ * is grabbed once for its duration and the pointer is only hidden/shown
+ * when its visibility actually changes, so switching modes is a pure state
+ * change rather than a round of grabs and cursor updates.
+ */
+
+static int cursor_hidden;
+
+static void set_cursor_hidden(int hidden)
+{
+	if (hidden == cursor_hidden)
+		return;
+
+	if (hidden)
+		platform->mouse_hide();
+	else
+		platform->mouse_show();
+
+	cursor_hidden = hidden;
+}
+
+void session_begin()
+{
+	platform->input_grab_keyboard();
+}
+
+/* Must be called before each mode in the session is entered. */
+void session_set_mode(int mode)
+{
+	int hidden;
+
+	switch (mode) {
+	case MODE_SCREEN_SELECTION:
+		hidden = 0;
+		break;
+	case MODE_NORMAL:
+		hidden = !config_get_int(CFG_NORMAL_SYSTEM_CURSOR);
+		break;
+	default:
+		hidden = 1;
+		break;
+	}
+
+	stats_set_mode(mode);
+	set_cursor_hidden(hidden);
+}
+
+void session_end()
+{
+	/* Keys typed after the one which ended the session were grabbed. */
+	input_flush();
+	set_cursor_hidden(0);
+	platform->input_ungrab_keyboard();
+	platform->commit();
+}
+
 int mode_loop(int initial_mode, int oneshot, int record_history)
 {
 	int mode = initial_mode;
 	int rc = 0;
 	struct input_event *ev = NULL;
 
+	session_begin();
+
 	while (1) {
 		int btn = 0;
 		config_input_whitelist(NULL, 0);
+		session_set_mode(mode);
 
 		switch (mode) {
 		case MODE_HISTORY:
@@ -24,20 +84,20 @@ int mode_loop(int initial_mode, int oneshot, int record_history)
 		case MODE_NORMAL:
 			ev = normal_mode(ev, oneshot);
 
-			if (config_input_match(ev, "history"))
+			if (config_input_match(ev, CFG_HISTORY))
 				mode = MODE_HISTORY;
-			else if (config_input_match(ev, "hint"))
+			else if (config_input_match(ev, CFG_HINT))
 				mode = MODE_HINT;
-			else if (config_input_match(ev, "hint2"))
+			else if (config_input_match(ev, CFG_HINT2))
 				mode = MODE_HINT2;
-			else if (config_input_match(ev, "grid"))
+			else if (config_input_match(ev, CFG_GRID))
 				mode = MODE_GRID;
-			else if (config_input_match(ev, "screen"))
+			else if (config_input_match(ev, CFG_SCREEN))
 				mode = MODE_SCREEN_SELECTION;
-			else if ((rc = config_input_match(ev, "oneshot_buttons")) || !ev) {
+			else if ((rc = config_input_match(ev, CFG_ONESHOT_BUTTONS)) || !ev) {
 				goto exit;
 			}
-			else if (config_input_match(ev, "exit") || !ev) {
+			else if (config_input_match(ev, CFG_EXIT) || !ev) {
 				rc = 0;
 				goto exit;
 			}
@@ -53,7 +113,7 @@ int mode_loop(int initial_mode, int oneshot, int record_history)
 			break;
 		case MODE_GRID:
 			ev = grid_mode();
-			if (config_input_match(ev, "grid_exit"))
+			if (config_input_match(ev, CFG_GRID_EXIT))
 				ev = NULL;
 			mode = MODE_NORMAL;
 			break;
@@ -64,7 +124,7 @@ int mode_loop(int initial_mode, int oneshot, int record_history)
 			break;
 		}
 
-		if (oneshot && (initial_mode != MODE_NORMAL || (btn = config_input_match(ev, "buttons")))) {
+		if (oneshot && (initial_mode != MODE_NORMAL || (btn = config_input_match(ev, CFG_BUTTONS)))) {
 			int x, y;
 			screen_t scr;
 
@@ -79,11 +139,15 @@ int mode_loop(int initial_mode, int oneshot, int record_history)
 			else
 				printf("%d %d\n", x, y);
 
-			return btn;
+			rc = btn;
+			goto exit;
 		}
+
+		stats_transition();
 	}
 
 exit:
+	session_end();
 	return rc;
 }
 
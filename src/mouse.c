@@ -7,6 +7,17 @@
 #include "warpd.h"
 #include <time.h>
 
+/*
+ * Motion is integrated in fixed steps of TIMESTEP us, independently of how
+ * often we are called, and the position handed to the platform is
+ * interpolated between the last two steps. This makes the trajectory a
+ * function of key timing alone rather than of the event/poll rate.
+ */
+#define TIMESTEP 2000
+
+/* Bound on the amount of time we catch up on after a stall. */
+#define MAX_CATCHUP 100000
+
 /* constants */
 
 static double v0, vf, vd, a, a0, a1;
@@ -27,6 +38,17 @@ static screen_t scr = 0;
 static double cx = 0;
 static double cy = 0;
 
+/* position at the previous step */
+static double px = 0;
+static double py = 0;
+
+/* time up to which motion has been integrated */
+static uint64_t sim_time = 0;
+
+/* last position passed to mouse_move() */
+static int lastx = -1;
+static int lasty = -1;
+
 static double v = 0;
 static int opnum = 0;
 
@@ -56,14 +78,9 @@ static void update_cursor_position()
 	cy = (double)iy;
 }
 
-static void tick()
+static void step()
 {
-	static long last_update = 0;
-
-	const long t = get_time_us();
-	const double elapsed = (double)(t - last_update) / 1E3;
-	last_update = t;
-
+	const double dt = TIMESTEP / 1E3;
 	const double dx = right - left;
 	const double dy = down - up;
 
@@ -72,8 +89,60 @@ static void tick()
 	const int miny = cursor_size/2;
 	const int minx = 1;
 
+	px = cx;
+	py = cy;
+
+	cx += v * dt * dx;
+	cy += v * dt * dy;
+
+	v += dt * a;
+	if (v > vf)
+		v = vf;
+
+	cx = cx < minx ? minx : cx;
+	cy = cy < miny ? miny : cy;
+	cy = cy > maxy ? maxy : cy;
+	cx = cx > maxx ? maxx : cx;
+}
+
+/* Integrates motion up to the given time. */
+static void advance(uint64_t t)
+{
+	if (resting)
+		return;
+
+	if (t - sim_time > MAX_CATCHUP)
+		sim_time = t - MAX_CATCHUP;
+
+	while (sim_time + TIMESTEP <= t) {
+		step();
+		sim_time += TIMESTEP;
+	}
+}
+
+/* Moves the pointer to the interpolated position at time t. */
+static void render(uint64_t t)
+{
+	const double alpha = (double)(t - sim_time) / TIMESTEP;
+	const int x = (int)(px + (cx - px) * alpha + .5);
+	const int y = (int)(py + (cy - py) * alpha + .5);
+
+	if (x != lastx || y != lasty) {
+		lastx = x;
+		lasty = y;
+		platform->mouse_move(scr, x, y);
+	}
+}
+
+static void tick()
+{
+	const uint64_t t = get_time_us();
+
+	if (!(right - left) && !(down - up)) {
+		/* Settle where the pointer was when the last key was released. */
+		if (!resting)
+			render(t);
 
-	if (!dx && !dy) {
 		resting = 1;
 		return;
 	}
@@ -83,27 +152,43 @@ static void tick()
 		if (!mode_slow){
 			v = v0;
 		}
+
+		px = cx;
+		py = cy;
+		lastx = (int)cx;
+		lasty = (int)cy;
+		sim_time = t;
 		resting = 0;
 	}
 
-	cx += v * elapsed * dx;
-	cy += v * elapsed * dy;
+	advance(t);
+	render(t);
+}
 
-	v += elapsed * a;
-	if (v > vf)
-		v = vf;
+/*
+ * Returns the frame period (in us) which yields one motion update per
+ * refresh of the given screen. Where the platform reports vblank, frames
+ * follow it instead (see timer_next_frame()) and this only bounds the
+ * wait for a vblank which never arrives.
+ */
+int frame_interval(screen_t scr)
+{
+	int rate = 0;
 
-	cx = cx < minx ? minx : cx;
-	cy = cy < miny ? miny : cy;
-	cy = cy > maxy ? maxy : cy;
-	cx = cx > maxx ? maxx : cx;
+	if (platform->screen_get_refresh_rate)
+		rate = platform->screen_get_refresh_rate(scr);
 
-	platform->mouse_move(scr, cx, cy);
+	/* Ignore implausible rates (and fall back to 100Hz if unknown). */
+	if (rate < 20000 || rate > 1000000)
+		return 10000;
+
+	return (int)(1E9 / rate + .5);
 }
 
 /*
  * The function to which continuous cursor movement is delegated for grid and
- * normal mode. Expects to be called every 10ms or so.
+ * normal mode. Expects to be called once per frame (see timer_next_frame()),
+ * though the resulting motion does not depend on the exact rate.
  *
  * mouse_reset() should be called at the beginning of the containing event
  * loop.
@@ -112,10 +197,10 @@ static void tick()
  */
 
 int mouse_process_key(struct input_event *ev,
-		      const char *up_key,
-		      const char *down_key,
-		      const char *left_key,
-		      const char *right_key)
+		      enum config_option up_key,
+		      enum config_option down_key,
+		      enum config_option left_key,
+		      enum config_option right_key)
 {
 	int ret = 0;
 	int n;
@@ -137,6 +222,9 @@ int mouse_process_key(struct input_event *ev,
 			return 1;
 	}
 
+	/* Apply the old direction up to the time of the event. */
+	advance(get_time_us());
+
 	if (config_input_match(ev, down_key)) {
 		down = ev->pressed;
 		ret = 1;
@@ -168,6 +256,7 @@ int mouse_process_key(struct input_event *ev,
 		right = 0;
 		up = 0;
 		down = 0;
+		resting = 1;
 
 		return 1;
 	}
@@ -178,11 +267,13 @@ int mouse_process_key(struct input_event *ev,
 
 void mouse_fast()
 {
+	advance(get_time_us());
 	a = a1;
 }
 
 void mouse_normal()
 {
+	advance(get_time_us());
 	v = v0;
 	a = a0;
 	mode_slow = 0;
@@ -190,11 +281,18 @@ void mouse_normal()
 
 void mouse_slow()
 {
+	advance(get_time_us());
 	v = vd;
 	a = 0;
 	mode_slow = 1;
 }
 
+/* Returns 1 while the pointer is in motion (i.e needs to be ticked). */
+int mouse_moving()
+{
+	return !resting;
+}
+
 void mouse_reset()
 {
 	opnum = 0;
@@ -204,6 +302,7 @@ void mouse_reset()
 	down = 0;
 	a = a0;
 	v = v0;
+	resting = 1;
 
 	update_cursor_position();
 
@@ -216,13 +315,13 @@ void init_mouse()
 
 	/* pixels/ms */
 
-	cursor_size = (config_get_int("cursor_size") * sh) / 1080;
+	cursor_size = (config_get_int(CFG_CURSOR_SIZE) * sh) / 1080;
 
-	v0 = (double)config_get_int("speed") / 1000.0;
-	vf = (double)config_get_int("max_speed") / 1000.0;
-	vd = (double)config_get_int("decelerator_speed") / 1000.0;
-	a0 = (double)config_get_int("acceleration") / 1000000.0;
-	a1 = (double)config_get_int("accelerator_acceleration") / 1000000.0;
+	v0 = (double)config_get_int(CFG_SPEED) / 1000.0;
+	vf = (double)config_get_int(CFG_MAX_SPEED) / 1000.0;
+	vd = (double)config_get_int(CFG_DECELERATOR_SPEED) / 1000.0;
+	a0 = (double)config_get_int(CFG_ACCELERATION) / 1000000.0;
+	a1 = (double)config_get_int(CFG_ACCELERATOR_ACCELERATION) / 1000000.0;
 
 	a = a0;
 }
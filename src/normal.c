@@ -13,11 +13,11 @@ static void redraw(screen_t scr, int x, int y, int hide_cursor)
 	platform->screen_get_dimensions(scr, &sw, &sh);
 
 	const int gap = 10;
-	const int indicator_size = (config_get_int("indicator_size") * sh) / 1080;
-	const char *indicator_color = config_get("indicator_color");
-	const char *curcol = config_get("cursor_color");
-	const char *indicator = config_get("indicator");
-	const int cursz = config_get_int("cursor_size");
+	const int indicator_size = (config_get_int(CFG_INDICATOR_SIZE) * sh) / 1080;
+	const uint32_t indicator_color = config_get_color(CFG_INDICATOR_COLOR);
+	const uint32_t curcol = config_get_color(CFG_CURSOR_COLOR);
+	const char *indicator = config_get(CFG_INDICATOR);
+	const int cursz = config_get_int(CFG_CURSOR_SIZE);
 
 	platform->screen_clear(scr);
 
@@ -47,98 +47,110 @@ static void move(screen_t scr, int x, int y, int hide_cursor)
 
 struct input_event *normal_mode(struct input_event *start_ev, int oneshot)
 {
-	const int cursz = config_get_int("cursor_size");
-	const int system_cursor = config_get_int("normal_system_cursor");
-	const char *blink_interval = config_get("normal_blink_interval");
+	const int cursz = config_get_int(CFG_CURSOR_SIZE);
+	const int system_cursor = config_get_int(CFG_NORMAL_SYSTEM_CURSOR);
+	const char *blink_interval = config_get(CFG_NORMAL_BLINK_INTERVAL);
 
 	int on_time, off_time;
 	struct input_event *ev;
 	screen_t scr;
 	int sh, sw;
 	int mx, my;
+	int moved;
 	int dragging = 0;
 	int show_cursor = !system_cursor;
 
+	/* Set if the pointer has moved since the cursor was last drawn. */
+	int dirty = 0;
+
 	int n = sscanf(blink_interval, "%d %d", &on_time, &off_time);
 	assert(n > 0);
 	if (n == 1)
 		off_time = on_time;
 
-	const char *keys[] = {
-		"accelerator",
-		"bottom",
-		"buttons",
-		"copy_and_exit",
-		"decelerator",
-		"down",
-		"drag",
-		"end",
-		"exit",
-		"grid",
-		"hint",
-		"hint2",
-		"hist_back",
-		"hist_forward",
-		"history",
-		"left",
-		"middle",
-		"oneshot_buttons",
-		"print",
-		"right",
-		"screen",
-		"scroll_down",
-		"scroll_up",
-		"start",
-		"top",
-		"up",
+	const enum config_option keys[] = {
+		CFG_ACCELERATOR,
+		CFG_BOTTOM,
+		CFG_BUTTONS,
+		CFG_COPY_AND_EXIT,
+		CFG_DECELERATOR,
+		CFG_DOWN,
+		CFG_DRAG,
+		CFG_END,
+		CFG_EXIT,
+		CFG_GRID,
+		CFG_HINT,
+		CFG_HINT2,
+		CFG_HIST_BACK,
+		CFG_HIST_FORWARD,
+		CFG_HISTORY,
+		CFG_LEFT,
+		CFG_MIDDLE,
+		CFG_ONESHOT_BUTTONS,
+		CFG_PRINT,
+		CFG_RIGHT,
+		CFG_SCREEN,
+		CFG_SCROLL_DOWN,
+		CFG_SCROLL_UP,
+		CFG_START,
+		CFG_TOP,
+		CFG_UP,
 	};
 
-	platform->input_grab_keyboard();
-
 	platform->mouse_get_position(&scr, &mx, &my);
 	platform->screen_get_dimensions(scr, &sw, &sh);
 
-	if (!system_cursor)
-		platform->mouse_hide();
-
 	mouse_reset();
 	redraw(scr, mx, my, !show_cursor);
 
-	uint64_t time = 0;
-	uint64_t last_blink_update = 0;
+	config_input_whitelist(keys, sizeof keys / sizeof keys[0]);
+
+	if (!system_cursor && on_time)
+		timer_set(TIMER_BLINK, get_time_us() + on_time * 1000);
+
 	while (1) {
-		config_input_whitelist(keys, sizeof keys / sizeof keys[0]);
+		/* A burst of motion keys is drawn once, after the last of them. */
+		if (dirty && !input_pending()) {
+			redraw(scr, mx, my, !show_cursor);
+			dirty = 0;
+		}
+
 		if (start_ev == NULL) {
-			ev = platform->input_next_event(10);
-			time += 10;
+			/* Only tick while there is something to animate. */
+			if (!mouse_moving() && !scroll_active())
+				timer_clear(TIMER_FRAME);
+			else if (!timer_armed(TIMER_FRAME))
+				timer_next_frame(scr);
+
+			ev = timer_next_event();
 		} else {
 			ev = start_ev;
 			start_ev = NULL;
 		}
 
+		if (timer_expired(TIMER_FRAME))
+			timer_next_frame(scr);
+
+		scroll_tick();
+		moved = mouse_process_key(ev, CFG_UP, CFG_DOWN, CFG_LEFT, CFG_RIGHT);
+
+		/* Read after the motion update so the cursor doesn't lag a frame behind. */
 		platform->mouse_get_position(&scr, &mx, &my);
 
-		if (!system_cursor && on_time) {
-			if (show_cursor && (time - last_blink_update) >= on_time) {
-				show_cursor = 0;
-				redraw(scr, mx, my, !show_cursor);
-				last_blink_update = time;
-			} else if (!show_cursor && (time - last_blink_update) >= off_time) {
-				show_cursor = 1;
-				redraw(scr, mx, my, !show_cursor);
-				last_blink_update = time;
-			}
+		if (timer_expired(TIMER_BLINK)) {
+			show_cursor = !show_cursor;
+			redraw(scr, mx, my, !show_cursor);
+			timer_advance(TIMER_BLINK, (show_cursor ? on_time : off_time) * 1000);
 		}
 
-		scroll_tick();
-		if (mouse_process_key(ev, "up", "down", "left", "right")) {
-			redraw(scr, mx, my, !show_cursor);
+		if (moved) {
+			dirty = 1;
 			continue;
 		}
 
 		if (!ev)  {
 			continue;
-		} else if (config_input_match(ev, "scroll_down")) {
+		} else if (config_input_match(ev, CFG_SCROLL_DOWN)) {
 			redraw(scr, mx, my, 1);
 
 			if (ev->pressed) {
@@ -146,7 +158,7 @@ struct input_event *normal_mode(struct input_event *start_ev, int oneshot)
 				scroll_accelerate(SCROLL_DOWN);
 			} else
 				scroll_decelerate();
-		} else if (config_input_match(ev, "scroll_up")) {
+		} else if (config_input_match(ev, CFG_SCROLL_UP)) {
 			redraw(scr, mx, my, 1);
 
 			if (ev->pressed) {
@@ -154,12 +166,12 @@ struct input_event *normal_mode(struct input_event *start_ev, int oneshot)
 				scroll_accelerate(SCROLL_UP);
 			} else
 				scroll_decelerate();
-		} else if (config_input_match(ev, "accelerator")) {
+		} else if (config_input_match(ev, CFG_ACCELERATOR)) {
 			if (ev->pressed)
 				mouse_fast();
 			else
 				mouse_normal();
-		} else if (config_input_match(ev, "decelerator")) {
+		} else if (config_input_match(ev, CFG_DECELERATOR)) {
 			if (ev->pressed)
 				mouse_slow();
 			else
@@ -168,74 +180,81 @@ struct input_event *normal_mode(struct input_event *start_ev, int oneshot)
 			goto next;
 		}
 
-		if (config_input_match(ev, "top"))
+		if (config_input_match(ev, CFG_TOP))
 			move(scr, mx, cursz / 2, !show_cursor);
-		else if (config_input_match(ev, "bottom"))
+		else if (config_input_match(ev, CFG_BOTTOM))
 			move(scr, mx, sh - cursz / 2, !show_cursor);
-		else if (config_input_match(ev, "middle"))
+		else if (config_input_match(ev, CFG_MIDDLE))
 			move(scr, mx, sh / 2, !show_cursor);
-		else if (config_input_match(ev, "start"))
+		else if (config_input_match(ev, CFG_START))
 			move(scr, 1, my, !show_cursor);
-		else if (config_input_match(ev, "end"))
+		else if (config_input_match(ev, CFG_END))
 			move(scr, sw - cursz, my, !show_cursor);
-		else if (config_input_match(ev, "hist_back")) {
+		else if (config_input_match(ev, CFG_HIST_BACK)) {
 			hist_add(mx, my);
 			hist_prev();
 			hist_get(&mx, &my);
 
 			move(scr, mx, my, !show_cursor);
-		} else if (config_input_match(ev, "hist_forward")) {
+		} else if (config_input_match(ev, CFG_HIST_FORWARD)) {
 			hist_next();
 			hist_get(&mx, &my);
 
 			move(scr, mx, my, !show_cursor);
-		} else if (config_input_match(ev, "drag")) {
+		} else if (config_input_match(ev, CFG_DRAG)) {
 			dragging = !dragging;
 			if (dragging)
-				platform->mouse_down(config_get_int("drag_button"));
+				platform->mouse_down(config_get_int(CFG_DRAG_BUTTON));
 			else
-				platform->mouse_up(config_get_int("drag_button"));
-		} else if (config_input_match(ev, "copy_and_exit")) {
-			platform->mouse_up(config_get_int("drag_button"));
+				platform->mouse_up(config_get_int(CFG_DRAG_BUTTON));
+		} else if (config_input_match(ev, CFG_COPY_AND_EXIT)) {
+			platform->mouse_up(config_get_int(CFG_DRAG_BUTTON));
 			platform->copy_selection();
 			ev = NULL;
 			goto exit;
-		} else if (config_input_match(ev, "exit") ||
-			   config_input_match(ev, "grid") ||
-			   config_input_match(ev, "screen") ||
-			   config_input_match(ev, "history") ||
-			   config_input_match(ev, "hint2") ||
-			   config_input_match(ev, "hint")) {
+		} else if (config_input_match(ev, CFG_EXIT) ||
+			   config_input_match(ev, CFG_GRID) ||
+			   config_input_match(ev, CFG_SCREEN) ||
+			   config_input_match(ev, CFG_HISTORY) ||
+			   config_input_match(ev, CFG_HINT2) ||
+			   config_input_match(ev, CFG_HINT)) {
 			goto exit;
-		} else if (config_input_match(ev, "print")) {
+		} else if (config_input_match(ev, CFG_PRINT)) {
 			printf("%d %d %s\n", mx, my, input_event_tostr(ev));
 			fflush(stdout);
 		} else { /* Mouse Buttons. */
 			int btn;
 
-			if ((btn = config_input_match(ev, "buttons"))) {
-				if (oneshot) {
-					printf("%d %d\n", mx, my);
-					exit(btn);
-				}
+			if ((btn = config_input_match(ev, CFG_BUTTONS))) {
+				/* Reported by mode_loop(). */
+				if (oneshot)
+					goto exit;
 
 				hist_add(mx, my);
 				histfile_add(mx, my);
 				platform->mouse_click(btn);
-			} else if ((btn = config_input_match(ev, "oneshot_buttons"))) {
+			} else if ((btn = config_input_match(ev, CFG_ONESHOT_BUTTONS))) {
 				hist_add(mx, my);
 				platform->mouse_click(btn);
 
-				const int timeout = config_get_int("oneshot_timeout");
+				const int timeout = config_get_int(CFG_ONESHOT_TIMEOUT);
+
+				timer_clear(TIMER_FRAME);
+				timer_clear(TIMER_BLINK);
 
 				while (1) {
-					struct input_event *ev = platform->input_next_event(timeout);
+					struct input_event *ev;
+
+					if (timeout)
+						timer_set(TIMER_ONESHOT, get_time_us() + timeout * 1000);
+
+					ev = timer_next_event();
 
 					if (!ev)
 						break;
 
 					if (ev && ev->pressed &&
-						config_input_match(ev, "oneshot_buttons")) {
+						config_input_match(ev, CFG_ONESHOT_BUTTONS)) {
 						platform->mouse_click(btn);
 					}
 				}
@@ -246,14 +265,17 @@ struct input_event *normal_mode(struct input_event *start_ev, int oneshot)
 	next:
 		platform->mouse_get_position(&scr, &mx, &my);
 
-		platform->commit();
+		/* The last event of a batch commits for the rest. */
+		if (!input_pending())
+			platform->commit();
 	}
 
 exit:
-	platform->mouse_show();
-	platform->screen_clear(scr);
+	timer_clear(TIMER_FRAME);
+	timer_clear(TIMER_BLINK);
+	timer_clear(TIMER_ONESHOT);
 
-	platform->input_ungrab_keyboard();
+	platform->screen_clear(scr);
 
 	platform->commit();
 	return ev;
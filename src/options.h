@@ -0,0 +1,118 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * The list of config options, intended to be included by code which defines
+ * X(id, name, val, description, type) (and thus deliberately lacks
+ * an include guard).
+ */
+
+X(HINT_ACTIVATION_KEY, "hint_activation_key", "A-M-x", "Activates hint mode.", OPT_KEY)
+X(HINT2_ACTIVATION_KEY, "hint2_activation_key", "A-M-X", "Activate two pass hint mode.", OPT_KEY)
+X(GRID_ACTIVATION_KEY, "grid_activation_key", "A-M-g", "Activates grid mode and allows for further manipulation of the pointer using the mapped keys.", OPT_KEY)
+X(HISTORY_ACTIVATION_KEY, "history_activation_key", "A-M-h", "Activate history mode.", OPT_KEY)
+X(SCREEN_ACTIVATION_KEY, "screen_activation_key", "A-M-s", "Activate (s)creen selection mode.", OPT_KEY)
+X(ACTIVATION_KEY, "activation_key", "A-M-c", "Activate normal movement mode (manual (c)ursor movement).", OPT_KEY)
+
+X(HINT_ONESHOT_KEY, "hint_oneshot_key", "A-M-l", "Activate hint mode and exit upon selection.", OPT_KEY)
+X(HINT2_ONESHOT_KEY, "hint2_oneshot_key", "A-M-L", "Activate two pass hint mode and exit upon selection.", OPT_KEY)
+
+/* Normal mode keys */
+
+X(EXIT, "exit", "esc", "Exit the currently active warpd session.", OPT_KEY)
+X(DRAG, "drag", "v", "Toggle drag mode (mnemonic (v)isual mode).", OPT_KEY)
+X(COPY_AND_EXIT, "copy_and_exit", "c", "Send the copy key and exit (useful in combination with v).", OPT_KEY)
+X(ACCELERATOR, "accelerator", "a", "Increase the acceleration of the pointer while held.", OPT_KEY)
+X(DECELERATOR, "decelerator", "d", "Decrease the speed of the pointer while held.", OPT_KEY)
+X(BUTTONS, "buttons", "m , .",  "A space separated list of mouse buttons (2 is middle click).", OPT_BUTTON)
+X(DRAG_BUTTON, "drag_button", "1", "The mouse buttton used for dragging.", OPT_INT)
+X(ONESHOT_BUTTONS, "oneshot_buttons", "n - /", "Oneshot mouse buttons (deactivate on click).", OPT_BUTTON)
+
+X(PRINT, "print", "p", "Print the current mouse coordinates to stdout (useful for scripts).", OPT_KEY)
+X(HISTORY, "history", ";", "Activate hint history mode while in normal mode.", OPT_KEY)
+X(HINT, "hint", "x", "Activate hint mode while in normal mode (mnemonic: x marks the spot?).", OPT_KEY)
+X(HINT2, "hint2", "X", "Activate two pass hint mode.", OPT_KEY)
+X(GRID, "grid", "g", "Activate (g)rid mode while in normal mode.", OPT_KEY)
+X(SCREEN, "screen", "s", "Activate (s)creen selection while in normal mode.", OPT_KEY)
+
+X(LEFT, "left", "h", "Move the cursor left in normal mode.", OPT_KEY)
+X(DOWN, "down", "j", "Move the cursor down in normal mode.", OPT_KEY)
+X(UP, "up", "k", "Move the cursor up in normal mode.", OPT_KEY)
+X(RIGHT, "right", "l", "Move the cursor right in normal mode.", OPT_KEY)
+X(TOP, "top", "H", "Moves the cursor to the top of the screen in normal mode.", OPT_KEY)
+X(MIDDLE, "middle", "M", "Moves the cursor to the middle of the screen in normal mode.", OPT_KEY)
+X(BOTTOM, "bottom", "L", "Moves the cursor to the bottom of the screen in normal mode.", OPT_KEY)
+X(START, "start", "0", "Moves the cursor to the leftmost corner of the screen in normal mode.", OPT_KEY)
+X(END, "end", "$", "Moves the cursor to the rightmost corner of the screen in normal mode.", OPT_KEY)
+
+X(SCROLL_DOWN, "scroll_down", "e", "Scroll down key.", OPT_KEY)
+X(SCROLL_UP, "scroll_up", "r", "Scroll up key.", OPT_KEY)
+
+X(CURSOR_COLOR, "cursor_color", "#FF4500", "The color of the pointer in normal mode (rgba hex value).", OPT_COLOR)
+
+X(CURSOR_SIZE, "cursor_size", "7", "The height of the pointer in normal mode.", OPT_INT)
+X(REPEAT_INTERVAL, "repeat_interval", "20", "The number of milliseconds before repeating a movement event.", OPT_INT)
+X(SPEED, "speed", "220", "Pointer speed in pixels/second.", OPT_INT)
+X(MAX_SPEED, "max_speed", "1600", "The maximum pointer speed.", OPT_INT)
+X(DECELERATOR_SPEED, "decelerator_speed", "50", "Pointer speed while decelerator is depressed.", OPT_INT)
+X(ACCELERATION, "acceleration", "700", "Pointer acceleration in pixels/second^2.", OPT_INT)
+X(ACCELERATOR_ACCELERATION, "accelerator_acceleration", "2900", "Pointer acceleration while the accelerator is depressed.", OPT_INT)
+X(ONESHOT_TIMEOUT, "oneshot_timeout", "300", "The length of time in milliseconds to wait for a second click after a oneshot key has been pressed.", OPT_INT)
+X(HIST_HINT_SIZE, "hist_hint_size", "2", "History hint size as a percentage of screen height.", OPT_INT)
+X(GRID_NR, "grid_nr", "2", "The number of rows in the grid.", OPT_INT)
+X(GRID_NC, "grid_nc", "2", "The number of columns in the grid.", OPT_INT)
+
+X(HIST_BACK, "hist_back", "C-o", "Move to the last position in the history stack.", OPT_KEY)
+X(HIST_FORWARD, "hist_forward", "C-i", "Move to the next position in the history stack.", OPT_KEY)
+
+X(GRID_UP, "grid_up", "w", "Move the grid up.", OPT_KEY)
+X(GRID_LEFT, "grid_left", "a", "Move the grid left.", OPT_KEY)
+X(GRID_DOWN, "grid_down", "s", "Move the grid down.", OPT_KEY)
+X(GRID_RIGHT, "grid_right", "d", "Move the grid right.", OPT_KEY)
+X(GRID_CUT_UP, "grid_cut_up", "W", "Cut the grid up.", OPT_KEY)
+X(GRID_CUT_LEFT, "grid_cut_left", "A", "Cut the grid left.", OPT_KEY)
+X(GRID_CUT_DOWN, "grid_cut_down", "S", "Cut the grid down.", OPT_KEY)
+X(GRID_CUT_RIGHT, "grid_cut_right", "D", "Cut the grid right.", OPT_KEY)
+X(GRID_KEYS, "grid_keys", "u i j k", "A sequence of comma delimited keybindings which are ordered bookwise with respect to grid position.", OPT_KEY)
+X(GRID_EXIT, "grid_exit", "c", "Exit grid mode and return to normal mode.", OPT_KEY)
+
+X(GRID_SIZE, "grid_size", "4", "The thickness of grid lines in pixels.", OPT_INT)
+X(GRID_BORDER_SIZE, "grid_border_size", "0", "The thickness of the grid border in pixels.", OPT_INT)
+
+X(GRID_COLOR, "grid_color", "#1c1c1e", "The color of the grid.", OPT_COLOR)
+X(GRID_BORDER_COLOR, "grid_border_color", "#ffffff", "The color of the grid border.", OPT_COLOR)
+
+X(HINT_BGCOLOR, "hint_bgcolor", "#1c1c1e", "The background hint color.", OPT_COLOR)
+X(HINT_FGCOLOR, "hint_fgcolor", "#a1aba7", "The foreground hint color.", OPT_COLOR)
+X(HINT_CHARS, "hint_chars", "abcdefghijklmnopqrstuvwxyz", "The character set from which hints are generated. The total number of hints is the square of the size of this string. It may be desirable to increase this for larger screens or trim it to increase gaps between hints.", OPT_STRING)
+X(HINT_FONT, "hint_font", "Arial", "The font name used by hints. Note: This is platform specific, in X it corresponds to a valid xft font name, on macos it corresponds to a postscript name.", OPT_STRING)
+
+X(HINT_SIZE, "hint_size", "20", "Hint size (range: 1-1000)", OPT_INT)
+X(HINT_BORDER_RADIUS, "hint_border_radius", "3", "Border radius.", OPT_INT)
+
+X(HINT_EXIT, "hint_exit", "esc", "The exit key used for hint mode.", OPT_KEY)
+X(HINT_UNDO, "hint_undo", "backspace", "undo last selection step in one of the hint based modes.", OPT_KEY)
+X(HINT_UNDO_ALL, "hint_undo_all", "C-u", "undo all selection steps in one of the hint based modes.", OPT_KEY)
+
+X(HINT2_CHARS, "hint2_chars", "hjkl;asdfgqwertyuiopzxcvb", "The character set used for the second hint selection, should consist of at least hint2_grid_size^2 characters.", OPT_STRING)
+X(HINT2_SIZE, "hint2_size", "20", "The size of hints in the secondary grid (range: 1-1000).", OPT_INT)
+X(HINT2_GAP_SIZE, "hint2_gap_size", "1", "The spacing between hints in the secondary grid. (range: 1-1000)", OPT_INT)
+X(HINT2_GRID_SIZE, "hint2_grid_size", "3", "The size of the secondary grid.", OPT_INT)
+
+X(SCREEN_CHARS, "screen_chars", "jkl;asdfg", "The characters used for screen selection.", OPT_STRING)
+
+X(SCROLL_SPEED, "scroll_speed", "300", "Initial scroll speed in units/second (unit varies by platform).", OPT_INT)
+X(SCROLL_MAX_SPEED, "scroll_max_speed", "9000", "Maximum scroll speed.", OPT_INT)
+X(SCROLL_ACCELERATION, "scroll_acceleration", "1600", "Scroll acceleration in units/second^2.", OPT_INT)
+X(SCROLL_DECELERATION, "scroll_deceleration", "-3400", "Scroll deceleration.", OPT_INT)
+
+X(INDICATOR, "indicator", "none", "Specifies an optional visual indicator to be displayed while normal mode is active, must be one of: topright, topleft, bottomright, bottomleft, none", OPT_STRING)
+X(INDICATOR_COLOR, "indicator_color", "#00ff00", "The color of the visual indicator color.", OPT_COLOR)
+X(INDICATOR_SIZE, "indicator_size", "12", "The size of the visual indicator in pixels.", OPT_INT)
+
+X(NORMAL_SYSTEM_CURSOR, "normal_system_cursor", "0", "If set to non-zero, use the system cursor instead of warpd's internal one.", OPT_INT)
+X(NORMAL_BLINK_INTERVAL, "normal_blink_interval", "0", "If set to non-zero, the blink interval of the normal mode cursor in miliseconds. If two values are supplied, the first corresponds to the time the cursor is visible, and the second corresponds to the amount of time it is invisible", OPT_STRING)
+
@@ -49,6 +49,29 @@ struct platform {
 	void (*input_ungrab_keyboard)();
 
 	struct input_event *(*input_next_event)(int timeout);
+
+	/*
+	 * Optional. Like input_next_event, but copies up to n pending events
+	 * into evs and returns the number copied (0 on timeout), so a burst
+	 * can be drained in one call.
+	 */
+	size_t (*input_next_events)(struct input_event *evs, size_t n, int timeout);
+
+	/*
+	 * Optional. Arms the given timer with an absolute deadline (in
+	 * CLOCK_MONOTONIC us, 0 disarms it). Once an armed timer expires,
+	 * input_next_event returns NULL even if it was called without a
+	 * timeout.
+	 */
+	void (*timer_arm)(int timer, uint64_t deadline);
+
+	/*
+	 * Optional. Requests that the given timer be expired with timer_fire()
+	 * at the next vblank of the screen. Returns 0 if the screen's vblank
+	 * can't be tracked.
+	 */
+	int (*timer_arm_vblank)(int timer, screen_t scr);
+
 	uint8_t (*input_lookup_code)(const char *name, int *shifted);
 	const char *(*input_lookup_name)(uint8_t code, int shifted);
 
@@ -70,11 +93,18 @@ struct platform {
 	void (*mouse_hide)();
 
 	void (*screen_get_dimensions)(screen_t scr, int *w, int *h);
-	void (*screen_draw_box)(screen_t scr, int x, int y, int w, int h, const char *color);
+	/* Colors are supplied as 0xRRGGBBAA. */
+	void (*screen_draw_box)(screen_t scr, int x, int y, int w, int h, uint32_t color);
 	void (*screen_clear)(screen_t scr);
 	void (*screen_list)(screen_t scr[MAX_SCREENS], size_t *n);
 
-	void (*init_hint)(const char *bg, const char *fg, int border_radius, const char *font_family);
+	/*
+	 * Optional. Returns the refresh rate of the screen in mHz, or 0 if it
+	 * is unknown.
+	 */
+	int (*screen_get_refresh_rate)(screen_t scr);
+
+	void (*init_hint)(uint32_t bg, uint32_t fg, int border_radius, const char *font_family);
 
 	/* 
 	 * Modifications to files passed into this function will interrupt
@@ -82,9 +112,27 @@ struct platform {
 	 */
 	void (*monitor_file)(const char *path);
 
+	/*
+	 * Optional. Readability of fds passed into this function will also
+	 * interrupt input_wait.
+	 */
+	void (*monitor_fd)(int fd);
+
 	/* Hints are centered around the provided x,y coordinates. */
 	void (*hint_draw)(struct screen *scr, struct hint *hints, size_t n);
 
+	/*
+	 * Optional. Erases the supplied subset of the hints last drawn with
+	 * hint_draw, leaving the remainder of the screen untouched.
+	 */
+	void (*hint_update)(struct screen *scr, struct hint *removed, size_t n);
+
+	/*
+	 * Optional. Called after init_hint with hints that are likely to be
+	 * drawn later, so that any rendering can be done ahead of time.
+	 */
+	void (*hint_prerender)(struct screen *scr, struct hint *hints, size_t n);
+
 	void (*scroll)(int direction);
 
 	void (*copy_selection)();
@@ -97,4 +145,16 @@ struct platform {
 };
 
 void platform_run(int (*main) (struct platform *platform));
+
+/*
+ * Implemented by the core. Backends should call this whenever their keymap
+ * is rebuilt (e.g on a layout change) so key bindings can be re-resolved.
+ */
+void config_keymap_changed();
+
+/*
+ * Implemented by the core. Expires a timer armed with timer_arm_vblank
+ * (backends call this once the vblank has been reported).
+ */
+void timer_fire(int timer);
 #endif
@@ -0,0 +1,638 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * An in-memory platform which doesn't require a display (PLATFORM=headless).
+ * Intended for benchmarking and exercising the core logic.
+ *
+ * Input is read from the script named by WARPD_HEADLESS_SCRIPT, one entry
+ * per line:
+ *
+ *	<key>		Press and release the key (e.g 'j', 'A-M-x', 'C-c').
+ *	+<key>		Press the key.
+ *	-<key>		Release the key.
+ *	repeat <n> <key>	Press and release the key n times.
+ *	wait <ms>	No input for the given number of milliseconds.
+ *	swap <k1> <k2>	Swap the names of two keys (i.e a layout change).
+ *
+ * Consecutive events (i.e those which aren't separated by a pause) arrive
+ * as a single burst. Lines starting with '#' are ignored. Once the script
+ * is exhausted any attempt to wait for input terminates the program.
+ *
+ * Screens may be specified with WARPD_HEADLESS_SCREENS as a comma separated
+ * list of <w>x<h>[+<x>+<y>][@<hz>] (default: 1920x1080). If WARPD_HEADLESS_LOG is
+ * set, every output operation is logged to stderr. A summary of all
+ * operations is printed to stderr on exit.
+ *
+ * If WARPD_HEADLESS_VIRTUAL is set, pauses advance a virtual clock (which
+ * replaces get_time_us()) instead of sleeping, so runs are fast and
+ * reproducible (see test/run.sh).
+ */
+
+#include "../../warpd.h"
+#include "../linux/inputq.h"
+
+#include <errno.h>
+#include <stdarg.h>
+
+struct screen {
+	int x;
+	int y;
+	int w;
+	int h;
+
+	/* mHz */
+	int refresh_rate;
+};
+
+struct script_entry {
+	struct input_event ev;
+
+	/* If non-zero, the entry is a pause (in ms) rather than an event. */
+	int wait;
+
+	/* If non-zero, the entry swaps the names of the given keys. */
+	uint8_t swap[2];
+};
+
+static struct {
+	size_t events;
+	size_t timeouts;
+
+	/* Time spent waiting on the script's pauses (ms). */
+	uint64_t waited;
+	size_t moves;
+	size_t clicks;
+	size_t downs;
+	size_t ups;
+	size_t scrolls;
+	size_t boxes;
+	size_t clears;
+	size_t hint_draws;
+	size_t hints_drawn;
+	size_t hint_updates;
+	size_t hints_removed;
+	size_t hints_prerendered;
+	size_t commits;
+	size_t grabs;
+	size_t copies;
+} stats;
+
+static struct screen screens[MAX_SCREENS];
+static size_t nr_screens;
+
+static struct screen *ptr_scr;
+static int ptr_x;
+static int ptr_y;
+
+static struct script_entry *script;
+static size_t script_len;
+static size_t script_pos;
+
+static int log_ops;
+static uint64_t start_time;
+
+/* us, only used if WARPD_HEADLESS_VIRTUAL is set. */
+static int virtual_clock;
+static uint64_t virtual_time = 1000000;
+
+/* Key names indexed by code (US layout). */
+static const char *keynames[][2] = {
+	{"", ""},
+
+	{"a", "A"}, {"b", "B"}, {"c", "C"}, {"d", "D"}, {"e", "E"}, {"f", "F"},
+	{"g", "G"}, {"h", "H"}, {"i", "I"}, {"j", "J"}, {"k", "K"}, {"l", "L"},
+	{"m", "M"}, {"n", "N"}, {"o", "O"}, {"p", "P"}, {"q", "Q"}, {"r", "R"},
+	{"s", "S"}, {"t", "T"}, {"u", "U"}, {"v", "V"}, {"w", "W"}, {"x", "X"},
+	{"y", "Y"}, {"z", "Z"},
+
+	{"0", ")"}, {"1", "!"}, {"2", "@"}, {"3", "#"}, {"4", "$"}, {"5", "%"},
+	{"6", "^"}, {"7", "&"}, {"8", "*"}, {"9", "("},
+
+	{"-", "_"}, {"=", "+"}, {"[", "{"}, {"]", "}"}, {";", ":"}, {"'", "\""},
+	{",", "<"}, {".", ">"}, {"/", "?"}, {"\\", "|"}, {"`", "~"},
+
+	{"esc", "esc"}, {"space", "space"}, {"backspace", "backspace"},
+	{"tab", "tab"}, {"enter", "enter"}, {"delete", "delete"},
+	{"up", "up"}, {"down", "down"}, {"left", "left"}, {"right", "right"},
+	{"home", "home"}, {"end", "end"}, {"pageup", "pageup"},
+	{"pagedown", "pagedown"},
+};
+
+#define NR_KEYS (sizeof keynames / sizeof keynames[0])
+
+static void oplog(const char *fmt, ...)
+{
+	va_list ap;
+
+	if (!log_ops)
+		return;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+
+	fputc('\n', stderr);
+}
+
+static void print_stats()
+{
+	uint64_t elapsed = get_real_time_us() - start_time;
+
+	fprintf(stderr,
+		"headless: %zu events (%zu timeouts) in %lu us (%.0f events/sec)\n"
+		"headless: %.1f timeouts per minute without input\n"
+		"headless: moves: %zu clicks: %zu downs: %zu ups: %zu scrolls: %zu copies: %zu\n"
+		"headless: hint draws: %zu (%zu hints) hint updates: %zu (%zu hints) prerendered: %zu boxes: %zu clears: %zu commits: %zu grabs: %zu\n"
+		"headless: pointer: %d %d\n",
+		stats.events, stats.timeouts, (unsigned long)elapsed,
+		elapsed ? stats.events * 1E6 / elapsed : 0,
+		stats.waited ? stats.timeouts * 60000.0 / stats.waited : 0,
+		stats.moves, stats.clicks, stats.downs, stats.ups,
+		stats.scrolls, stats.copies,
+		stats.hint_draws, stats.hints_drawn,
+		stats.hint_updates, stats.hints_removed,
+		stats.hints_prerendered, stats.boxes, stats.clears, stats.commits, stats.grabs,
+		ptr_x, ptr_y);
+}
+
+static void script_exhausted()
+{
+	oplog("end of script");
+	print_stats();
+	exit(0);
+}
+
+static uint64_t get_virtual_time_us()
+{
+	return virtual_time;
+}
+
+static void sleep_ms(int ms)
+{
+	struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+
+	if (virtual_clock) {
+		virtual_time += (uint64_t)ms * 1000;
+		return;
+	}
+
+	while (nanosleep(&ts, &ts) && errno == EINTR)
+		;
+}
+
+static uint8_t lookup_code(const char *name, int *shifted)
+{
+	size_t i;
+
+	for (i = 1; i < NR_KEYS; i++) {
+		if (!strcmp(keynames[i][0], name)) {
+			*shifted = 0;
+			return i;
+		}
+
+		if (!strcmp(keynames[i][1], name)) {
+			*shifted = 1;
+			return i;
+		}
+	}
+
+	return 0;
+}
+
+static const char *lookup_name(uint8_t code, int shifted)
+{
+	if (code >= NR_KEYS)
+		return NULL;
+
+	return keynames[code][shifted ? 1 : 0];
+}
+
+static void swap_keys(uint8_t c1, uint8_t c2)
+{
+	const char *tmp[2];
+
+	memcpy(tmp, keynames[c1], sizeof tmp);
+	memcpy(keynames[c1], keynames[c2], sizeof tmp);
+	memcpy(keynames[c2], tmp, sizeof tmp);
+
+	oplog("swap %d %d", c1, c2);
+	config_keymap_changed();
+}
+
+static void script_add(struct input_event *ev, int wait, uint8_t swap1, uint8_t swap2)
+{
+	static size_t sz;
+
+	if (script_len == sz) {
+		sz = sz ? sz * 2 : 1024;
+		script = realloc(script, sz * sizeof script[0]);
+		assert(script);
+	}
+
+	if (ev)
+		script[script_len].ev = *ev;
+
+	script[script_len].wait = wait;
+	script[script_len].swap[0] = swap1;
+	script[script_len].swap[1] = swap2;
+	script_len++;
+}
+
+static void load_script(const char *path)
+{
+	char line[256];
+	size_t lineno = 0;
+	FILE *fh = fopen(path, "r");
+
+	if (!fh) {
+		perror(path);
+		exit(-1);
+	}
+
+	while (fgets(line, sizeof line, fh)) {
+		struct input_event ev;
+		size_t len = strlen(line);
+		const char *s = line;
+		int ms;
+		int repeat = 1;
+		char k1[32], k2[32];
+
+		lineno++;
+
+		while (len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			line[--len] = 0;
+
+		if (!len || line[0] == '#')
+			continue;
+
+		if (sscanf(line, "wait %d", &ms) == 1) {
+			if (ms > 0)
+				script_add(NULL, ms, 0, 0);
+			continue;
+		}
+
+		/* Keys are named according to the initial layout. */
+		if (sscanf(line, "swap %31s %31s", k1, k2) == 2) {
+			int shifted;
+			uint8_t c1 = lookup_code(k1, &shifted);
+			uint8_t c2 = lookup_code(k2, &shifted);
+
+			if (!c1 || !c2) {
+				fprintf(stderr, "ERROR: %s:%zu: invalid key: %s\n", path, lineno, line);
+				exit(-1);
+			}
+
+			script_add(NULL, 0, c1, c2);
+			continue;
+		}
+
+		if (sscanf(line, "repeat %d %31s", &repeat, k1) == 2)
+			s = k1;
+		else if ((s[0] == '+' || s[0] == '-') && s[1])
+			s++;
+
+		if (input_parse_string(&ev, s) || !ev.code) {
+			fprintf(stderr, "ERROR: %s:%zu: invalid key: %s\n", path, lineno, s);
+			exit(-1);
+		}
+
+		while (repeat-- > 0) {
+			if (line[0] != '-') {
+				ev.pressed = 1;
+				script_add(&ev, 0, 0, 0);
+			}
+
+			if (line[0] != '+') {
+				ev.pressed = 0;
+				script_add(&ev, 0, 0, 0);
+			}
+		}
+	}
+
+	fclose(fh);
+}
+
+static void parse_screens(const char *s)
+{
+	while (s && *s && nr_screens < MAX_SCREENS) {
+		struct screen *scr = &screens[nr_screens];
+		int n = sscanf(s, "%dx%d+%d+%d", &scr->w, &scr->h, &scr->x, &scr->y);
+		const char *rate = strchr(s, '@');
+		const char *next = strchr(s, ',');
+
+		if (n < 2 || scr->w <= 0 || scr->h <= 0) {
+			fprintf(stderr, "ERROR: invalid screen specification: %s\n", s);
+			exit(-1);
+		}
+
+		if (n < 4)
+			scr->x = scr->y = 0;
+
+		if (rate && (!next || rate < next))
+			scr->refresh_rate = atof(rate + 1) * 1000;
+		else
+			scr->refresh_rate = 0;
+
+		nr_screens++;
+
+		if ((s = strchr(s, ',')))
+			s++;
+	}
+}
+
+/* Reads the next event from the script, or returns NULL on timeout. */
+static struct input_event *script_next_event(int timeout)
+{
+	static int loaded = 0;
+
+	/* Deferred since parsing keys requires the platform to be set up. */
+	if (!loaded) {
+		if (getenv("WARPD_HEADLESS_SCRIPT"))
+			load_script(getenv("WARPD_HEADLESS_SCRIPT"));
+		loaded = 1;
+	}
+
+	while (1) {
+		struct script_entry *ent;
+
+		if (script_pos == script_len)
+			script_exhausted();
+
+		ent = &script[script_pos];
+
+		if (ent->swap[0]) {
+			swap_keys(ent->swap[0], ent->swap[1]);
+			script_pos++;
+			continue;
+		}
+
+		if (!ent->wait) {
+			script_pos++;
+			stats.events++;
+			return &ent->ev;
+		}
+
+		if (timeout && timeout < ent->wait) {
+			sleep_ms(timeout);
+			ent->wait -= timeout;
+			stats.waited += timeout;
+			stats.timeouts++;
+			return NULL;
+		}
+
+		sleep_ms(ent->wait);
+		stats.waited += ent->wait;
+		script_pos++;
+	}
+}
+
+/*
+ * Entries up to the next pause arrive together (as they would in a single
+ * display dispatch), so they are queued at once and handed out in batches.
+ */
+static size_t input_next_events(struct input_event *evs, size_t n, int timeout)
+{
+	if (inputq_empty()) {
+		struct input_event *ev = script_next_event(timeout);
+
+		if (!ev)
+			return 0;
+
+		inputq_push(ev->code, ev->pressed, ev->mods);
+
+		while (script_pos < script_len &&
+		       !script[script_pos].wait && !script[script_pos].swap[0]) {
+			ev = &script[script_pos++].ev;
+			stats.events++;
+
+			inputq_push(ev->code, ev->pressed, ev->mods);
+		}
+	}
+
+	return inputq_pop(evs, n);
+}
+
+static struct input_event *next_event(int timeout)
+{
+	static struct input_event ev;
+
+	return input_next_events(&ev, 1, timeout) ? &ev : NULL;
+}
+
+static struct input_event *input_wait(struct input_event *events, size_t sz)
+{
+	while (1) {
+		size_t i;
+		struct input_event *ev = next_event(0);
+
+		if (!ev->pressed)
+			continue;
+
+		for (i = 0; i < sz; i++) {
+			if (events[i].code == ev->code && events[i].mods == ev->mods) {
+				stats.grabs++;
+				return ev;
+			}
+		}
+	}
+}
+
+static void input_grab_keyboard()
+{
+	stats.grabs++;
+	oplog("grab");
+}
+
+static void input_ungrab_keyboard()
+{
+	oplog("ungrab");
+}
+
+static void mouse_move(struct screen *scr, int x, int y)
+{
+	ptr_scr = scr;
+	ptr_x = x;
+	ptr_y = y;
+
+	stats.moves++;
+	oplog("move %d %d", x, y);
+}
+
+static void mouse_down(int btn)
+{
+	stats.downs++;
+	oplog("down %d", btn);
+}
+
+static void mouse_up(int btn)
+{
+	stats.ups++;
+	oplog("up %d", btn);
+}
+
+static void mouse_click(int btn)
+{
+	stats.clicks++;
+	oplog("click %d", btn);
+}
+
+static void mouse_get_position(struct screen **scr, int *x, int *y)
+{
+	if (scr)
+		*scr = ptr_scr;
+	if (x)
+		*x = ptr_x;
+	if (y)
+		*y = ptr_y;
+}
+
+static void mouse_show()
+{
+	oplog("show");
+}
+
+static void mouse_hide()
+{
+	oplog("hide");
+}
+
+static void screen_get_dimensions(struct screen *scr, int *w, int *h)
+{
+	*w = scr->w;
+	*h = scr->h;
+}
+
+static int screen_get_refresh_rate(struct screen *scr)
+{
+	return scr->refresh_rate;
+}
+
+static void screen_draw_box(struct screen *scr, int x, int y, int w, int h, uint32_t color)
+{
+	stats.boxes++;
+	oplog("box %d %d %d %d #%08x", x, y, w, h, (unsigned int)color);
+}
+
+static void screen_clear(struct screen *scr)
+{
+	stats.clears++;
+	oplog("clear");
+}
+
+static void screen_list(struct screen *scr[MAX_SCREENS], size_t *n)
+{
+	size_t i;
+
+	for (i = 0; i < nr_screens; i++)
+		scr[i] = &screens[i];
+
+	*n = nr_screens;
+}
+
+static void init_hint(uint32_t bg, uint32_t fg, int border_radius, const char *font_family)
+{
+}
+
+static void monitor_file(const char *path)
+{
+}
+
+static void hint_draw(struct screen *scr, struct hint *hints, size_t n)
+{
+	stats.hint_draws++;
+	stats.hints_drawn += n;
+	oplog("hint_draw %zu", n);
+}
+
+static void hint_update(struct screen *scr, struct hint *removed, size_t n)
+{
+	stats.hint_updates++;
+	stats.hints_removed += n;
+	oplog("hint_update %zu", n);
+}
+
+static void hint_prerender(struct screen *scr, struct hint *hints, size_t n)
+{
+	stats.hints_prerendered += n;
+	oplog("hint_prerender %zu", n);
+}
+
+static void scroll(int direction)
+{
+	stats.scrolls++;
+	oplog("scroll %d", direction);
+}
+
+static void copy_selection()
+{
+	stats.copies++;
+	oplog("copy");
+}
+
+static void commit()
+{
+	stats.commits++;
+}
+
+static void headless_init(struct platform *platform)
+{
+	parse_screens(getenv("WARPD_HEADLESS_SCREENS"));
+	if (!nr_screens)
+		parse_screens("1920x1080");
+
+	ptr_scr = &screens[0];
+	ptr_x = ptr_scr->w / 2;
+	ptr_y = ptr_scr->h / 2;
+
+	log_ops = getenv("WARPD_HEADLESS_LOG") != NULL;
+
+	if ((virtual_clock = getenv("WARPD_HEADLESS_VIRTUAL") != NULL))
+		set_clock_source(get_virtual_time_us);
+
+	platform->input_grab_keyboard = input_grab_keyboard;
+	platform->input_ungrab_keyboard = input_ungrab_keyboard;
+	platform->input_next_event = next_event;
+	platform->input_next_events = input_next_events;
+	platform->input_lookup_code = lookup_code;
+	platform->input_lookup_name = lookup_name;
+	platform->input_wait = input_wait;
+	platform->mouse_move = mouse_move;
+	platform->mouse_down = mouse_down;
+	platform->mouse_up = mouse_up;
+	platform->mouse_click = mouse_click;
+	platform->mouse_get_position = mouse_get_position;
+	platform->mouse_show = mouse_show;
+	platform->mouse_hide = mouse_hide;
+	platform->screen_get_dimensions = screen_get_dimensions;
+	platform->screen_draw_box = screen_draw_box;
+	platform->screen_clear = screen_clear;
+	platform->screen_list = screen_list;
+	platform->screen_get_refresh_rate = screen_get_refresh_rate;
+	platform->init_hint = init_hint;
+	platform->monitor_file = monitor_file;
+	platform->hint_draw = hint_draw;
+	platform->hint_update = hint_update;
+	platform->hint_prerender = hint_prerender;
+	platform->scroll = scroll;
+	platform->copy_selection = copy_selection;
+	platform->commit = commit;
+
+	start_time = get_real_time_us();
+}
+
+void platform_run(int (*main) (struct platform *platform))
+{
+	int rc;
+	static struct platform platform;
+
+	headless_init(&platform);
+
+	rc = main(&platform);
+	print_stats();
+
+	exit(rc);
+}
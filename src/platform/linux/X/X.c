@@ -8,54 +8,82 @@
 
 Display *dpy = NULL;
 
-struct monitored_file monitored_files[32];
-size_t nr_monitored_files = 0;
+unsigned long x_roundtrips[NR_RT];
 
-int hex_to_rgba(const char *str, uint8_t *r, uint8_t *g, uint8_t *b, uint8_t *a)
-{
-#define X2B(c) ((c >= '0' && c <= '9') ? (c & 0xF) : (((c | 0x20) - 'a') + 10))
+enum {
+	ATOM_COMPTON_SHADOW,
+	ATOM_OPACITY,
 
-	if (str == NULL)
-		return 0;
-	str = (*str == '#') ? str + 1 : str;
+	NR_ATOMS
+};
 
-	ssize_t len = strlen(str);
+static char *atom_names[] = {
+	[ATOM_COMPTON_SHADOW] = "_COMPTON_SHADOW",
+	[ATOM_OPACITY] = "_NET_WM_WINDOW_OPACITY",
+};
 
-	if (len != 6 && len != 8)
-		return -1;
+static Atom atoms[NR_ATOMS];
 
-	*r = X2B(str[0]);
-	*r <<= 4;
-	*r |= X2B(str[1]);
+struct monitored_file monitored_files[32];
+size_t nr_monitored_files = 0;
 
-	*g = X2B(str[2]);
-	*g <<= 4;
-	*g |= X2B(str[3]);
+/* Files which couldn't be watched and must be checked periodically. */
+size_t nr_polled_files = 0;
+static int inotify_fd = -1;
+
+/* Scales an 8 bit channel value into the given TrueColor mask. */
+static uint32_t channel_pixel(uint8_t v, unsigned long mask)
+{
+	int shift = 0;
+	int bits = 0;
 
-	*b = X2B(str[4]);
-	*b <<= 4;
-	*b |= X2B(str[5]);
+	while (mask && !(mask & 1)) {
+		mask >>= 1;
+		shift++;
+	}
 
-	*a = 255;
-	if (len == 8) {
-		*a = X2B(str[6]);
-		*a <<= 4;
-		*a |= X2B(str[7]);
+	while (mask & 1) {
+		mask >>= 1;
+		bits++;
 	}
 
-	return 0;
+	if (bits >= 8)
+		return ((uint32_t)v << (bits - 8)) << shift;
+	else
+		return ((uint32_t)v >> (8 - bits)) << shift;
 }
 
-uint32_t parse_xcolor(const char *s, uint8_t *opacity)
+/*
+ * On TrueColor visuals (i.e virtually always) the pixel value is computed
+ * locally. Otherwise it is allocated from the server, once per colour.
+ */
+uint32_t xcolor_pixel(uint32_t color, uint8_t *opacity)
 {
+	size_t i;
 	XColor col;
+	Visual *vis = DefaultVisual(dpy, DefaultScreen(dpy));
 
-	uint8_t r, g, b, a;
+	static struct {
+		uint8_t r, g, b;
+		uint32_t pixel;
+	} colors[64];
+	static size_t nr_colors = 0;
 
-	hex_to_rgba(s, &r, &g, &b, &a);
+	const uint8_t r = color >> 24;
+	const uint8_t g = color >> 16;
+	const uint8_t b = color >> 8;
 
 	if (opacity)
-		*opacity = a;
+		*opacity = color & 0xFF;
+
+	if (vis->class == TrueColor)
+		return channel_pixel(r, vis->red_mask) |
+		       channel_pixel(g, vis->green_mask) |
+		       channel_pixel(b, vis->blue_mask);
+
+	for (i = 0; i < nr_colors; i++)
+		if (colors[i].r == r && colors[i].g == g && colors[i].b == b)
+			return colors[i].pixel;
 
 	col.red = (int)r << 8;
 	col.green = (int)g << 8;
@@ -64,6 +92,15 @@ uint32_t parse_xcolor(const char *s, uint8_t *opacity)
 
 	assert(
 	    XAllocColor(dpy, XDefaultColormap(dpy, DefaultScreen(dpy)), &col));
+	ROUNDTRIP(RT_COLORS);
+
+	if (nr_colors < sizeof colors / sizeof colors[0]) {
+		colors[nr_colors].r = r;
+		colors[nr_colors].g = g;
+		colors[nr_colors].b = b;
+		colors[nr_colors].pixel = col.pixel;
+		nr_colors++;
+	}
 
 	return col.pixel;
 }
@@ -76,21 +113,18 @@ uint32_t parse_xcolor(const char *s, uint8_t *opacity)
  */
 static void disable_compton_shadow(Display *dpy, Window w)
 {
-	Atom _COMPTON_SHADOW = XInternAtom(dpy, "_COMPTON_SHADOW", False);
 	unsigned int v = 0;
 
-	XChangeProperty(dpy, w, _COMPTON_SHADOW, XA_CARDINAL, 32,
+	XChangeProperty(dpy, w, atoms[ATOM_COMPTON_SHADOW], XA_CARDINAL, 32,
 			PropModeReplace, (unsigned char *)&v, 1L);
 }
 
 static void set_opacity(Display *dpy, Window w, uint8_t _opacity)
 {
-	Atom OPACITY_ATOM = XInternAtom(dpy, "_NET_WM_WINDOW_OPACITY", False);
-
 	unsigned int opacity =
 	    (unsigned int)(((double)_opacity / 255) * (double)0xffffffff);
 
-	XChangeProperty(dpy, w, OPACITY_ATOM, XA_CARDINAL, 32, PropModeReplace,
+	XChangeProperty(dpy, w, atoms[ATOM_OPACITY], XA_CARDINAL, 32, PropModeReplace,
 			(unsigned char *)&opacity, 1L);
 }
 
@@ -105,7 +139,10 @@ void x_copy_selection()
 			  CurrentTime);
 	XTestFakeKeyEvent(dpy, XKeysymToKeycode(dpy, XK_Insert), False,
 			  CurrentTime);
+
+	/* xclip must observe the copy. */
 	XSync(dpy, False);
+	ROUNDTRIP(RT_COPY_SELECTION);
 
 	system("xclip -o|xclip -selection CLIPBOARD");
 }
@@ -133,13 +170,22 @@ void x_scroll(int direction)
 	XTestFakeButtonEvent(dpy, btn, False, CurrentTime);
 }
 
-Window create_window(const char *color)
+/* Recolors a window created with create_window(). */
+void window_set_background(Window w, uint32_t color)
+{
+	uint8_t opacity;
+
+	XSetWindowBackground(dpy, w, xcolor_pixel(color, &opacity));
+	set_opacity(dpy, w, opacity);
+}
+
+Window create_window(uint32_t color)
 {
 	uint32_t col = 0;
 	XClassHint *hint;
 	uint8_t opacity;
 
-	col = parse_xcolor(color, &opacity);
+	col = xcolor_pixel(color, &opacity);
 
 	Window win = XCreateWindow(
 	    dpy, DefaultRootWindow(dpy), 0, 0, 1, 1, 0,
@@ -168,9 +214,43 @@ Window create_window(const char *color)
 	return win;
 }
 
+/*
+ * The only place requests are synchronized with the server unless a reply
+ * is required. Everything else is queued and pipelined up to here.
+ */
 void x_commit()
 {
 	XSync(dpy, False);
+	ROUNDTRIP(RT_COMMIT);
+}
+
+static void print_roundtrips()
+{
+	size_t i;
+	unsigned long total = 0;
+	static const char *names[] = {
+		[RT_COMMIT] = "commit",
+		[RT_POINTER] = "mouse_get_position",
+		[RT_GRAB_KEYBOARD] = "input_grab_keyboard",
+		[RT_UNGRAB_KEYBOARD] = "input_ungrab_keyboard",
+		[RT_GRAB_KEYS] = "input_wait",
+		[RT_COPY_SELECTION] = "copy_selection",
+		[RT_SCREENS] = "init (screens)",
+		[RT_ATOMS] = "init (atoms)",
+		[RT_COLORS] = "alloc_color",
+	};
+
+	fprintf(stderr, "X round trips:\n");
+	for (i = 0; i < NR_RT; i++) {
+		fprintf(stderr, "\t%-24s %lu\n", names[i], x_roundtrips[i]);
+		total += x_roundtrips[i];
+	}
+
+	fprintf(stderr, "\t%-24s %lu (%.2f per commit)\n", "total", total,
+		x_roundtrips[RT_COMMIT] ? (double)total / x_roundtrips[RT_COMMIT] : 0);
+
+	fprintf(stderr, "Keyboard grabs: %lu (mean: %lu us)\n", x_nr_grabs,
+		x_nr_grabs ? (unsigned long)(x_grab_time / x_nr_grabs) : 0);
 }
 
 long x_get_mtime(const char *path)
@@ -182,21 +262,104 @@ long x_get_mtime(const char *path)
 	return st.st_mtime;
 }
 
+/*
+ * Watches the directory containing path and stores the name of the file
+ * within it. Returns the watch descriptor or -1.
+ */
+static int watch_dir(const char *path, char *name, size_t sz)
+{
+	char dir[1024];
+	char base[1024];
+
+	snprintf(dir, sizeof dir, "%s", path);
+	snprintf(base, sizeof base, "%s", path);
+	snprintf(name, sz, "%s", basename(base));
+
+	return inotify_add_watch(inotify_fd, dirname(dir),
+				 IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+}
+
 void x_monitor_file(const char *path)
 {
-	/*
-	 * OPT: We could use inotify, but that would reduce portability and involve
-	 * additional logic to handle renames. Polling is good enough.
-	 */
+	char target[PATH_MAX];
 	struct monitored_file *mf = &monitored_files[nr_monitored_files];
 	assert(nr_monitored_files < sizeof (monitored_files) / sizeof(monitored_files[0]));
 
 	strncpy(mf->path, path, sizeof mf->path);
 	mf->mtime = x_get_mtime(path);
+	mf->wd = -1;
+	mf->target_wd = -1;
+
+	if (inotify_fd < 0 &&
+	    (inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) >= 0)
+		reactor_add_fd(inotify_fd, REACTOR_FILES);
+
+	if (inotify_fd >= 0) {
+		mf->wd = watch_dir(path, mf->name, sizeof mf->name);
+
+		if (realpath(path, target) && strcmp(target, path))
+			mf->target_wd = watch_dir(target, mf->target_name,
+						  sizeof mf->target_name);
+	}
+
+	if (mf->wd < 0)
+		nr_polled_files++;
 
 	nr_monitored_files++;
 }
 
+/*
+ * Consumes pending inotify events and checks any polled files. Returns 1
+ * if one of the monitored files has changed.
+ */
+int x_monitored_files_changed()
+{
+	size_t i;
+	ssize_t n;
+	int changed = 0;
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	while (inotify_fd >= 0 && (n = read(inotify_fd, buf, sizeof buf)) > 0) {
+		char *ptr;
+		struct inotify_event *ev;
+
+		for (ptr = buf; ptr < buf + n; ptr += sizeof *ev + ev->len) {
+			ev = (struct inotify_event *)ptr;
+
+			if (!ev->len)
+				continue;
+
+			for (i = 0; i < nr_monitored_files; i++) {
+				struct monitored_file *mf = &monitored_files[i];
+
+				if ((ev->wd == mf->wd && !strcmp(ev->name, mf->name)) ||
+				    (ev->wd == mf->target_wd && !strcmp(ev->name, mf->target_name)))
+					changed = 1;
+			}
+		}
+	}
+
+	for (i = 0; i < nr_monitored_files; i++) {
+		struct monitored_file *mf = &monitored_files[i];
+
+		if (mf->wd < 0) {
+			long mtime = x_get_mtime(mf->path);
+
+			if (mtime != mf->mtime) {
+				mf->mtime = mtime;
+				changed = 1;
+			}
+		}
+	}
+
+	return changed;
+}
+
+void x_monitor_fd(int fd)
+{
+	reactor_add_fd(fd, REACTOR_FDS);
+}
+
 void x_init(struct platform *platform)
 {
 	dpy = XOpenDisplay(NULL);
@@ -205,13 +368,30 @@ void x_init(struct platform *platform)
 		exit(-1);
 	}
 
+	reactor_add_fd(XConnectionNumber(dpy), REACTOR_DISPLAY);
+
+#ifdef WARPD_XCB
+	xcb_init();
+	xcb_intern_atoms(atom_names, atoms, NR_ATOMS);
+#else
+	XInternAtoms(dpy, atom_names, NR_ATOMS, False, atoms);
+#endif
+	ROUNDTRIP(RT_ATOMS);
+
 	/* TODO: account for screen hotplugging */
 	init_xscreens();
+	init_vblank();
+	init_pointer();
+	init_keyboards();
+	init_keytable();
 
 	platform->monitor_file = x_monitor_file;
+	platform->monitor_fd = x_monitor_fd;
 	platform->commit = x_commit;
 	platform->copy_selection = x_copy_selection;
 	platform->hint_draw = x_hint_draw;
+	platform->hint_update = x_hint_update;
+	platform->hint_prerender = x_hint_prerender;
 	platform->init_hint = x_init_hint;
 	platform->input_grab_keyboard = x_input_grab_keyboard;
 	platform->input_lookup_code = x_input_lookup_code;
@@ -230,5 +410,11 @@ void x_init(struct platform *platform)
 	platform->screen_draw_box = x_screen_draw_box;
 	platform->screen_get_dimensions = x_screen_get_dimensions;
 	platform->screen_list = x_screen_list;
+	platform->screen_get_refresh_rate = x_screen_get_refresh_rate;
 	platform->scroll = x_scroll;
+	platform->timer_arm = reactor_timer_set;
+	platform->timer_arm_vblank = x_timer_arm_vblank;
+
+	if (getenv("WARPD_X_ROUNDTRIPS"))
+		atexit(print_roundtrips);
 }
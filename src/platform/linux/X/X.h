@@ -9,6 +9,8 @@
 
 #include "../../../platform.h"
 #include "../../../warpd.h"
+#include "../keytable.h"
+#include "../reactor.h"
 
 #include <X11/Xatom.h>
 #include <X11/Xft/Xft.h>
@@ -18,6 +20,8 @@
 #include <X11/extensions/XTest.h>
 #include <X11/extensions/Xfixes.h>
 #include <X11/extensions/Xinerama.h>
+#include <X11/extensions/Xpresent.h>
+#include <X11/extensions/Xrandr.h>
 #include <X11/extensions/shape.h>
 #include <X11/keysym.h>
 #include <assert.h>
@@ -26,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/inotify.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <libgen.h>
@@ -34,7 +39,7 @@
 
 struct box {
 	Window win;
-	char color[32];
+	uint32_t color;
 	int mapped;
 };
 
@@ -46,6 +51,12 @@ struct screen {
 	int w;
 	int h;
 
+	/* mHz, 0 if unknown */
+	int refresh_rate;
+
+	/* Unmapped, receives the vblank notifications for the screen. */
+	Window vblankwin;
+
 	Pixmap buf;
 
 	Window hintwin;
@@ -53,6 +64,16 @@ struct screen {
 	Window cached_hintwin;
 	Pixmap cached_hintbuf;
 
+	/* The window last drawn by x_hint_draw. */
+	Window active_hintwin;
+
+	/*
+	 * Unmapped window holding the pristine shape of cached_hintwin, so
+	 * it can be restored after x_hint_update without recomputing the mask.
+	 */
+	Window cached_hintshape;
+	int cached_hintwin_dirty;
+
 	struct hint cached_hints[MAX_HINTS];
 	size_t nr_cached_hints;
 
@@ -63,21 +84,75 @@ struct screen {
 struct monitored_file {
 	char path[1024];
 	long mtime;
+
+	/*
+	 * inotify watches on the containing directory (to survive rename
+	 * based saves) and on that of the symlink target (if any), along
+	 * with the names to look for in each. -1 if the file is polled.
+	 */
+	int wd;
+	char name[256];
+
+	int target_wd;
+	char target_name[256];
 };
 
-Window create_window(const char *color);
+Window create_window(uint32_t color);
+void window_set_background(Window w, uint32_t color);
 
-int hex_to_rgba(const char *str, uint8_t *r, uint8_t *g, uint8_t *b,
-		     uint8_t *a);
-uint32_t parse_xcolor(const char *s, uint8_t *opacity);
+uint32_t xcolor_pixel(uint32_t color, uint8_t *opacity);
 void init_xscreens();
+void init_pointer();
+void init_keyboards();
+void init_keytable();
+void x_track_pointer(int enable);
+void x_process_raw_motion(XIRawEvent *ev);
+void init_vblank();
+int x_process_vblank_event(XEvent *ev);
+int x_mode_refresh_rate(unsigned long dot_clock, unsigned int htotal,
+			unsigned int vtotal, unsigned long flags);
+
+#ifdef WARPD_XCB
+/*
+ * Batched alternatives to the equivalent Xlib calls which issue all
+ * requests before waiting on any of the replies (see xcb.c).
+ */
+void xcb_init();
+void xcb_intern_atoms(char *names[], Atom atoms[], size_t n);
+size_t xcb_query_screens(struct screen *screens, size_t max);
+void xcb_grab_keyboards(const int ids[], size_t n, uint8_t keymap[32]);
+#endif
+
+/*
+ * Round trips made to the server after initialization, by operation.
+ * Printed on exit if WARPD_X_ROUNDTRIPS is set.
+ */
+enum {
+	RT_COMMIT,
+	RT_POINTER,
+	RT_GRAB_KEYBOARD,
+	RT_UNGRAB_KEYBOARD,
+	RT_GRAB_KEYS,
+	RT_COPY_SELECTION,
+	RT_SCREENS,
+	RT_ATOMS,
+	RT_COLORS,
+
+	NR_RT
+};
+
+#define ROUNDTRIP(op) (x_roundtrips[op]++)
 
 /* Globals. */
 extern Display *dpy;
+extern unsigned long x_roundtrips[NR_RT];
+extern uint64_t x_grab_time;
+extern unsigned long x_nr_grabs;
 
 extern struct screen xscreens[32];
 extern size_t nr_xscreens;
 extern uint8_t x_active_mods;
+extern int x_xi_opcode;
 
 void x_init();
 
@@ -95,18 +170,25 @@ void x_mouse_get_position(screen_t *scr, int *x, int *y);
 void x_mouse_show();
 void x_mouse_hide();
 void x_screen_get_dimensions(screen_t scr, int *w, int *h);
-void x_screen_draw_box(screen_t scr, int x, int y, int w, int h, const char *color);
+int x_screen_get_refresh_rate(screen_t scr);
+int x_timer_arm_vblank(int timer, screen_t scr);
+void x_screen_draw_box(screen_t scr, int x, int y, int w, int h, uint32_t color);
 void x_screen_clear(screen_t scr);
 void x_screen_list(screen_t scr[MAX_SCREENS], size_t *n);
-void x_init_hint(const char *bg, const char *fg, int border_radius, const char *font_family);
+void x_init_hint(uint32_t bg, uint32_t fg, int border_radius, const char *font_family);
 void x_hint_draw(struct screen *scr, struct hint *hints, size_t n);
+void x_hint_update(struct screen *scr, struct hint *removed, size_t n);
+void x_hint_prerender(struct screen *scr, struct hint *hints, size_t n);
 void x_scroll(int direction);
 void x_copy_selection();
 void x_commit();
 void x_monitor_file(const char *path);
+void x_monitor_fd(int fd);
 long x_get_mtime(const char *path);
+int x_monitored_files_changed();
 
 extern struct monitored_file monitored_files[32];
 extern size_t nr_monitored_files;
+extern size_t nr_polled_files;
 
 #endif
@@ -7,23 +7,44 @@
 #include "X.h"
 
 static int border_radius;
-static const char *font_family;
-static const char *fgcolor;
-static const char *bgcolor;
 
-static XftColor parse_xft_color(const char *s)
+/* Copied, since config strings don't outlive a reload. */
+static char font_family[256];
+
+static XftColor fgcol;
+static GC bggc;
+
+/*
+ * Pre-rendered hint labels (background + text) keyed by label and size.
+ * Tiles for the fullscreen hints are rendered by x_hint_prerender() when
+ * the hint style is set, any others the first time they are drawn. Each is
+ * subsequently blitted with a single XCopyArea. The cache is flushed
+ * whenever the hint style changes.
+ */
+#define MAX_LABEL_TILES 4096
+
+struct label_tile {
+	char label[16];
+	int w;
+	int h;
+	Pixmap pm;
+};
+
+static struct label_tile label_tiles[MAX_LABEL_TILES];
+static size_t nr_label_tiles;
+
+static XftDraw *tile_draw;
+
+static XftColor alloc_xft_color(uint32_t rgba)
 {
-	uint8_t r, g, b, a;
 	XftColor color;
 	XRenderColor rc;
 
 	int scr = DefaultScreen(dpy);
 
-	hex_to_rgba(s, &r, &g, &b, &a);
-
-	rc.red = r * 257;
-	rc.green = g * 257;
-	rc.blue = b * 257;
+	rc.red = (rgba >> 24) * 257;
+	rc.green = ((rgba >> 16) & 0xFF) * 257;
+	rc.blue = ((rgba >> 8) & 0xFF) * 257;
 	rc.alpha = ~0;
 
 	XftColorAllocValue(dpy, DefaultVisual(dpy, scr),
@@ -40,40 +61,46 @@ static XftFont *get_font(const char *name, int height)
 	char xftname[256];
 	int h;
 
-	if (!strcmp(cached_name, name) &&
+	if (font && !strcmp(cached_name, name) &&
 		    cached_height == height)
 		return font;
 
-	strcpy(cached_name, name);
+	if (font)
+		XftFontClose(dpy, font);
+
+	snprintf(cached_name, sizeof cached_name, "%s", name);
 	cached_height = height;
 
 	h = height;
-	do {
+	while (1) {
 		snprintf(xftname, sizeof xftname, "%s:pixelsize=%d", name, h);
 		font = XftFontOpenName(dpy, DefaultScreen(dpy), xftname);
 
+		if (font->height <= height || h <= 1)
+			break;
+
+		XftFontClose(dpy, font);
 		h--;
-	} while (font->height > height);
+	}
 
 	return font;
 }
 
-static int draw_text(Drawable drw, int x, int y, int w, int h,
-		     const char *fontname, const char *s)
+static void draw_text(Drawable drw, int x, int y, int w, int h,
+		      const char *fontname, const char *s)
 {
-	XftDraw *xftdrw;
-	XftColor col;
-
 	XftFont *font;
 
 	XGlyphInfo e;
 	int font_height;
 
 	font = get_font(fontname, h - 3);
-	col = parse_xft_color(fgcolor);
 
-	xftdrw = XftDrawCreate(dpy, drw, DefaultVisual(dpy, DefaultScreen(dpy)),
-			       DefaultColormap(dpy, DefaultScreen(dpy)));
+	if (!tile_draw)
+		tile_draw = XftDrawCreate(dpy, drw, DefaultVisual(dpy, DefaultScreen(dpy)),
+					  DefaultColormap(dpy, DefaultScreen(dpy)));
+	else
+		XftDrawChange(tile_draw, drw);
 
 	XftTextExtentsUtf8(dpy, font, (FcChar8 *)s, strlen(s), &e);
 	font_height = font->ascent + font->descent;
@@ -81,10 +108,62 @@ static int draw_text(Drawable drw, int x, int y, int w, int h,
 	x += (w - e.width) / 2;
 	y += (h-font_height) / 2 + font->ascent;
 
-	XftDrawStringUtf8(xftdrw, &col, font, x, y, (FcChar8 *)s,
+	XftDrawStringUtf8(tile_draw, &fgcol, font, x, y, (FcChar8 *)s,
 			  strlen(s));
+}
+
+static void flush_label_tiles()
+{
+	size_t i;
+
+	for (i = 0; i < MAX_LABEL_TILES; i++) {
+		if (label_tiles[i].pm)
+			XFreePixmap(dpy, label_tiles[i].pm);
+	}
+
+	memset(label_tiles, 0, sizeof label_tiles);
+	nr_label_tiles = 0;
+}
+
+static Pixmap get_label_tile(const char *label, int w, int h)
+{
+	size_t i;
+	uint32_t hash = 2166136261u;
+	const char *c;
+	struct label_tile *tile;
+
+	for (c = label; *c; c++)
+		hash = (hash ^ (uint8_t)*c) * 16777619u;
+	hash = (hash ^ (uint32_t)w) * 16777619u;
+	hash = (hash ^ (uint32_t)h) * 16777619u;
+
+	for (i = hash % MAX_LABEL_TILES;; i = (i + 1) % MAX_LABEL_TILES) {
+		tile = &label_tiles[i];
+
+		if (!tile->pm)
+			break;
+
+		if (tile->w == w && tile->h == h && !strcmp(tile->label, label))
+			return tile->pm;
+	}
 
-	return 0;
+	/* Keep the table sparse enough for short probe sequences. */
+	if (nr_label_tiles >= MAX_LABEL_TILES / 2) {
+		flush_label_tiles();
+		return get_label_tile(label, w, h);
+	}
+
+	snprintf(tile->label, sizeof tile->label, "%s", label);
+	tile->w = w;
+	tile->h = h;
+	tile->pm = XCreatePixmap(dpy, DefaultRootWindow(dpy), w, h,
+				 DefaultDepth(dpy, DefaultScreen(dpy)));
+
+	XFillRectangle(dpy, tile->pm, bggc, 0, 0, w, h);
+	draw_text(tile->pm, 0, 0, w, h, font_family, label);
+
+	nr_label_tiles++;
+	return tile->pm;
 }
 
 static void draw_rounded_rectangle(Drawable drw, GC gc, unsigned int x,
@@ -111,39 +190,31 @@ void do_hint_draw(struct screen *scr, Window win, struct hint *hints, size_t n,
 
 	Pixmap mask = XCreatePixmap(dpy, win, scr->w, scr->h, 1);
 	GC gc = XCreateGC(dpy, mask, 0, NULL);
-	GC mgc = XCreateGC(dpy, DefaultRootWindow(dpy),
-			   GCForeground | GCFillStyle,
-			   &(XGCValues){
-			   .foreground = parse_xcolor(bgcolor, NULL),
-			   .fill_style = FillSolid,
-			   });
 
 	XSetForeground(dpy, gc, 0);
 	XFillRectangle(dpy, mask, gc, 0, 0, scr->w, scr->h);
 	XSetForeground(dpy, gc, 1);
 
-	XFillRectangle(dpy, buf, mgc, 0, 0, scr->w, scr->h);
-
+	/* Only the hint areas are visible, so there is no need to clear buf. */
 	for (i = 0; i < n; i++) {
 		struct hint *h = &hints[i];
 
 		draw_rounded_rectangle(mask, gc, h->x, h->y, h->w, h->h,
 				       border_radius);
 
-		draw_text(buf, h->x, h->y,
-			  h->w, h->h, font_family, h->label);
+		XCopyArea(dpy, get_label_tile(h->label, h->w, h->h), buf, bggc,
+			  0, 0, h->w, h->h, h->x, h->y);
 	}
 
 	/* Expensive for large masks. */
 	XShapeCombineMask(dpy, win, ShapeBounding, 0, 0, mask, ShapeSet);
 
 	XMoveWindow(dpy, win, scr->x, scr->y);
-	XCopyArea(dpy, buf, win, mgc, 0, 0, scr->w, scr->h, 0, 0);
+	XCopyArea(dpy, buf, win, bggc, 0, 0, scr->w, scr->h, 0, 0);
 	XRaiseWindow(dpy, win);
 
 	XFreePixmap(dpy, mask);
 	XFreeGC(dpy, gc);
-	XFreeGC(dpy, mgc);
 }
 
 void x_hint_draw(struct screen *scr, struct hint *hints, size_t n)
@@ -157,19 +228,19 @@ void x_hint_draw(struct screen *scr, struct hint *hints, size_t n)
 	/* Use the cached window, if it exists. */
 	if (n == scr->nr_cached_hints &&
 	    !memcmp(scr->cached_hints, hints, sizeof(struct hint) * n)) {
-		GC gc = XCreateGC(dpy, DefaultRootWindow(dpy),
-				   GCForeground | GCFillStyle,
-				   &(XGCValues){
-				   .foreground = parse_xcolor(bgcolor, NULL),
-				   .fill_style = FillSolid,
-				   });
+		if (scr->cached_hintwin_dirty) {
+			XShapeCombineShape(dpy, scr->cached_hintwin, ShapeBounding,
+					   0, 0, scr->cached_hintshape,
+					   ShapeBounding, ShapeSet);
+			scr->cached_hintwin_dirty = 0;
+		}
 
 		XMoveWindow(dpy, scr->cached_hintwin, scr->x, scr->y);
 		XCopyArea(dpy, scr->cached_hintbuf, scr->cached_hintwin,
-			  gc, 0, 0, scr->w, scr->h, 0, 0);
+			  bggc, 0, 0, scr->w, scr->h, 0, 0);
 		XRaiseWindow(dpy, scr->cached_hintwin);
 
-		XFreeGC(dpy, gc);
+		scr->active_hintwin = scr->cached_hintwin;
 		return;
 	}
 
@@ -191,19 +262,67 @@ void x_hint_draw(struct screen *scr, struct hint *hints, size_t n)
 
 
 	do_hint_draw(scr, win, hints, n, buf);
+	scr->active_hintwin = win;
+
+	if (win == scr->cached_hintwin) {
+		XShapeCombineShape(dpy, scr->cached_hintshape, ShapeBounding,
+				   0, 0, win, ShapeBounding, ShapeSet);
+		scr->cached_hintwin_dirty = 0;
+	}
+}
+
+/*
+ * Punch the removed hints out of the window shape instead of rebuilding the
+ * full screen mask. The cost is proportional to the number of removed hints.
+ */
+void x_hint_update(struct screen *scr, struct hint *removed, size_t n)
+{
+	size_t i;
+	XRectangle rects[MAX_HINTS];
+
+	assert(n <= MAX_HINTS);
+	for (i = 0; i < n; i++) {
+		rects[i].x = removed[i].x;
+		rects[i].y = removed[i].y;
+		rects[i].width = removed[i].w;
+		rects[i].height = removed[i].h;
+	}
+
+	XShapeCombineRectangles(dpy, scr->active_hintwin, ShapeBounding, 0, 0,
+				rects, n, ShapeSubtract, Unsorted);
+
+	if (scr->active_hintwin == scr->cached_hintwin)
+		scr->cached_hintwin_dirty = 1;
 }
 
-void x_init_hint(const char *bgcol, const char *fgcol, int _border_radius,
+void x_hint_prerender(struct screen *scr, struct hint *hints, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		get_label_tile(hints[i].label, hints[i].w, hints[i].h);
+}
+
+void x_init_hint(uint32_t bgcol, uint32_t fgcol_rgba, int _border_radius,
 		 const char *_font_family)
 {
 	static int init = 0;
 	size_t i;
 
-	bgcolor = bgcol;
-	fgcolor = fgcol;
 	border_radius = _border_radius;
-	font_family = _font_family;
+	snprintf(font_family, sizeof font_family, "%s", _font_family);
+
+	if (init)
+		XftColorFree(dpy, DefaultVisual(dpy, DefaultScreen(dpy)),
+			     DefaultColormap(dpy, DefaultScreen(dpy)), &fgcol);
+
+	fgcol = alloc_xft_color(fgcol_rgba);
+
+	if (!bggc)
+		bggc = XCreateGC(dpy, DefaultRootWindow(dpy), 0, NULL);
+	XSetForeground(dpy, bggc, xcolor_pixel(bgcol, NULL));
 
+	flush_label_tiles();
 
 	if (!init) {
 		for (i = 0; i < nr_xscreens; i++) {
@@ -211,6 +330,9 @@ void x_init_hint(const char *bgcol, const char *fgcol, int _border_radius,
 
 			scr->hintwin = create_window(bgcol);
 			scr->cached_hintwin = create_window(bgcol);
+			scr->cached_hintshape = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy),
+								    0, 0, scr->w, scr->h,
+								    0, 0, 0);
 
 			scr->buf =
 			    XCreatePixmap(dpy, DefaultRootWindow(dpy), scr->w, scr->h,
@@ -226,6 +348,14 @@ void x_init_hint(const char *bgcol, const char *fgcol, int _border_radius,
 			XMapWindow(dpy, scr->hintwin);
 			XMapWindow(dpy, scr->cached_hintwin);
 		}
+
+		init = 1;
+	} else {
+		/* e.g a reload which changed hint_bgcolor. */
+		for (i = 0; i < nr_xscreens; i++) {
+			window_set_background(xscreens[i].hintwin, bgcol);
+			window_set_background(xscreens[i].cached_hintwin, bgcol);
+		}
 	}
 
 	for (i = 0; i < nr_xscreens; i++)
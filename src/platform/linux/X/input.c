@@ -9,25 +9,139 @@
 static int nr_grabbed_device_ids = 0;
 static int grabbed_device_ids[64];
 
+/*
+ * Physical keyboards (excluding XTEST devices). Queried once and kept
+ * current with XI_HierarchyChanged events, so entering a mode doesn't
+ * need to query the server.
+ */
+static struct {
+	int id;
+	int enabled;
+} keyboards[64];
+static size_t nr_keyboards;
+
+/* Set when devices have been added or removed since the last query. */
+static int keyboards_stale = 1;
+
+static void update_keytable();
+
+/* Set once the keymap has been rebuilt, see x_input_wait(). */
+static int keymap_updated = 0;
+
+/* Total time spent in x_input_grab_keyboard() (see print_roundtrips()). */
+uint64_t x_grab_time;
+unsigned long x_nr_grabs;
 
 uint8_t x_active_mods = 0;
 
-/* clear the X keyboard state. */
-static void reset_keyboard()
+/* Major opcode of the X Input extension. */
+int x_xi_opcode;
+
+/* Sends a key up event for each key depressed in the supplied keymap. */
+static void release_keys(const uint8_t keymap[32])
 {
 	size_t i;
-	char keymap[32];
-
-	XQueryKeymap(dpy, keymap);
 
 	for (i = 0; i < 256; i++) {
 		if (0x01 & keymap[i / 8] >> (i % 8))
 			XTestFakeKeyEvent(dpy, i, 0, CurrentTime);
 	}
+}
 
-	XSync(dpy, False);
+static void update_keyboards()
+{
+	int i, n;
+	XIDeviceInfo *devices;
+
+	if (!keyboards_stale)
+		return;
+
+	devices = XIQueryDevice(dpy, XIAllDevices, &n);
+	ROUNDTRIP(RT_GRAB_KEYBOARD);
+
+	nr_keyboards = 0;
+	for (i = 0; i < n && nr_keyboards < sizeof keyboards / sizeof keyboards[0]; i++) {
+		if ((devices[i].use == XISlaveKeyboard ||
+		     devices[i].use == XIFloatingSlave) &&
+		    !strstr(devices[i].name, "XTEST")) {
+			keyboards[nr_keyboards].id = devices[i].deviceid;
+			keyboards[nr_keyboards].enabled = devices[i].enabled;
+			nr_keyboards++;
+		}
+	}
+
+	XIFreeDeviceInfo(devices);
+	keyboards_stale = 0;
+}
+
+static int keyboard_enabled(int id)
+{
+	size_t i;
+
+	for (i = 0; i < nr_keyboards; i++)
+		if (keyboards[i].id == id)
+			return keyboards[i].enabled;
+
+	return 0;
+}
+
+static void process_hierarchy_event(XIHierarchyEvent *ev)
+{
+	int i;
+	size_t j;
+
+	for (i = 0; i < ev->num_info; i++) {
+		XIHierarchyInfo *info = &ev->info[i];
+
+		for (j = 0; j < nr_keyboards; j++)
+			if (keyboards[j].id == info->deviceid)
+				keyboards[j].enabled = info->enabled &&
+						       !(info->flags & XISlaveRemoved);
+
+		/* New devices need to be queried for their name. */
+		if (info->flags & (XISlaveAdded | XISlaveRemoved |
+				   XISlaveAttached | XISlaveDetached))
+			keyboards_stale = 1;
+	}
+}
+
+static Bool is_hierarchy_event(Display *dpy, XEvent *ev, XPointer arg)
+{
+	return ev->xcookie.type == GenericEvent &&
+	       ev->xcookie.extension == x_xi_opcode &&
+	       ev->xcookie.evtype == XI_HierarchyChanged;
+}
+
+/* Accounts for any hierarchy changes which have arrived but not been processed. */
+static void process_pending_hierarchy_events()
+{
+	XEvent ev;
+
+	while (XCheckIfEvent(dpy, &ev, is_hierarchy_event, NULL)) {
+		if (XGetEventData(dpy, &ev.xcookie)) {
+			process_hierarchy_event(ev.xcookie.data);
+			XFreeEventData(dpy, &ev.xcookie);
+		}
+	}
+}
+
+void init_keyboards()
+{
+	XIEventMask mask;
+	unsigned char bits[XIMaskLen(XI_LASTEVENT)] = {0};
+
+	/* Hierarchy events are only delivered to XIAllDevices selections. */
+	XISetMask(bits, XI_HierarchyChanged);
+
+	mask.deviceid = XIAllDevices;
+	mask.mask_len = sizeof bits;
+	mask.mask = bits;
+
+	XISelectEvents(dpy, DefaultRootWindow(dpy), &mask, 1);
+	update_keyboards();
 }
 
+#ifndef WARPD_XCB
 static void grab(int device_id)
 {
 	int rc;
@@ -41,9 +155,12 @@ static void grab(int device_id)
 	XISetMask(mask.mask, XI_KeyPress);
 	XISetMask(mask.mask, XI_KeyRelease);
 
-	if ((rc = XIGrabDevice(dpy, device_id, DefaultRootWindow(dpy),
-			       CurrentTime, None, GrabModeAsync, GrabModeAsync,
-			       False, &mask))) {
+	rc = XIGrabDevice(dpy, device_id, DefaultRootWindow(dpy),
+			  CurrentTime, None, GrabModeAsync, GrabModeAsync,
+			  False, &mask);
+	ROUNDTRIP(RT_GRAB_KEYBOARD);
+
+	if (rc) {
 		int n;
 
 		XIDeviceInfo *info = XIQueryDevice(dpy, device_id, &n);
@@ -52,37 +169,56 @@ static void grab(int device_id)
 		exit(-1);
 	}
 
-	XSync(dpy, False);
+	free(mask.mask);
 }
+#endif
 
-/* timeout in ms. */
-static XEvent *get_next_xev(int timeout)
+/*
+ * Returns the next X event, or NULL once the deadline (if any) has passed,
+ * one of the supplied additional sources has become readable or the keymap
+ * has changed. The set of readable sources is stored in ready (if supplied).
+ */
+static XEvent *get_next_xev(uint64_t deadline, int sources, int *ready)
 {
-	static int xfd = 0;
 	static XEvent ev;
-	char buf[1024];
 
-	if (XPending(dpy)) {
-		XNextEvent(dpy, &ev);
-		return &ev;
-	}
+	while (1) {
+		int n;
+
+		if (XPending(dpy)) {
+			XNextEvent(dpy, &ev);
+
+			if (x_process_vblank_event(&ev))
+				continue;
+
+			/* e.g setxkbmap, the keymap needs to be reloaded. */
+			if (ev.type == MappingNotify) {
+				XRefreshKeyboardMapping(&ev.xmapping);
+
+				if (ev.xmapping.request == MappingKeyboard) {
+					update_keytable();
+					config_keymap_changed();
+					keymap_updated = 1;
+
+					if (ready)
+						*ready = 0;
+					return NULL;
+				}
 
-	fd_set fds;
+				continue;
+			}
 
-	if (!xfd)
-		xfd = XConnectionNumber(dpy);
+			return &ev;
+		}
 
-	FD_ZERO(&fds);
-	FD_SET(xfd, &fds);
+		n = reactor_wait(REACTOR_DISPLAY | sources, deadline);
 
-	select(xfd + 1, &fds, NULL, NULL,
-	       timeout ? &(struct timeval){0, timeout * 1000} : NULL);
+		if (ready)
+			*ready = n;
 
-	if (XPending(dpy)) {
-		XNextEvent(dpy, &ev);
-		return &ev;
-	} else
-		return NULL;
+		if (!(n & REACTOR_DISPLAY))
+			return NULL;
+	}
 }
 
 /* returns a key code or 0 on failure. */
@@ -90,20 +226,8 @@ static uint8_t process_xinput_event(XEvent *ev, int *state, int *mods)
 {
 	XGenericEventCookie *cookie = &ev->xcookie;
 
-	static int xiop = 0;
-	if (!xiop) {
-		int ev, err;
-
-		if (!XQueryExtension(dpy, "XInputExtension", &xiop, &ev,
-				     &err)) {
-			fprintf(stderr,
-				"FATAL: X Input extension not available.\n");
-			exit(-1);
-		}
-	}
-
 	/* not a xinput event.. */
-	if (cookie->type != GenericEvent || cookie->extension != xiop ||
+	if (cookie->type != GenericEvent || cookie->extension != x_xi_opcode ||
 	    !XGetEventData(dpy, cookie))
 		return 0;
 
@@ -131,20 +255,42 @@ static uint8_t process_xinput_event(XEvent *ev, int *state, int *mods)
 		XFreeEventData(dpy, cookie);
 
 		return code;
+	case XI_RawMotion:
+		x_process_raw_motion(cookie->data);
+		XFreeEventData(dpy, cookie);
+
+		return 0;
+	case XI_HierarchyChanged:
+		process_hierarchy_event(cookie->data);
+		XFreeEventData(dpy, cookie);
+
+		return 0;
 	}
 
 	fprintf(stderr, "FATAL: Unrecognized xinput event\n");
 	exit(-1);
 }
 
-static const char *xerr_key = NULL;
-static int input_xerr(Display *dpy, XErrorEvent *ev)
-{
-	fprintf(stderr,
-		"ERROR: Failed to grab %s (ensure it isn't mapped by another application)\n",
-		xerr_key);
-	return 0;
-}
+/*
+ * The first request serial of each key grabbed by set_grabbed_keys(), used
+ * to attribute errors to keys once the grabs have been synchronized.
+ */
+#define MAX_GRAB_KEYS 64
+
+static struct {
+	unsigned long serial;
+	struct input_event ev;
+	int failed;
+} grab_requests[MAX_GRAB_KEYS];
+static size_t nr_grab_requests;
+
+/* The activation keys currently grabbed on the root window. */
+static struct input_event grabbed_keys[MAX_GRAB_KEYS];
+static size_t nr_grabbed_keys;
+
+/* Lock modifier combinations which don't affect the meaning of a key. */
+static unsigned int lock_masks[8];
+static size_t nr_lock_masks;
 
 static const char *input_tostr(struct input_event *ev)
 {
@@ -175,13 +321,74 @@ static const char *input_tostr(struct input_event *ev)
 	return s;
 }
 
-static void xgrab_key(uint8_t code, uint8_t mods, int grab)
+static int input_xerr(Display *dpy, XErrorEvent *ev)
 {
-	XSetErrorHandler(input_xerr);
-	int xmods = 0;
+	size_t i;
+	const char *key = "UNDEFINED";
 
-	if (!code)
-		return;
+	for (i = 0; i < nr_grab_requests && grab_requests[i].serial <= ev->serial; i++)
+		;
+
+	if (i) {
+		/* Each key is grabbed once per lock combination, report it once. */
+		if (grab_requests[i - 1].failed)
+			return 0;
+
+		grab_requests[i - 1].failed = 1;
+		key = input_tostr(&grab_requests[i - 1].ev);
+	}
+
+	fprintf(stderr,
+		"ERROR: Failed to grab %s (ensure it isn't mapped by another application)\n",
+		key);
+	return 0;
+}
+
+/* Returns the modifier mask the given keysym is bound to (or 0). */
+static unsigned int keysym_mask(XModifierKeymap *map, KeySym sym)
+{
+	int i;
+	KeyCode code = XKeysymToKeycode(dpy, sym);
+
+	for (i = 0; code && i < 8 * map->max_keypermod; i++)
+		if (map->modifiermap[i] == code)
+			return 1 << (i / map->max_keypermod);
+
+	return 0;
+}
+
+/*
+ * Computes every combination of CapsLock, NumLock and ScrollLock so
+ * activation keys still work while any of them are on.
+ */
+static void init_lock_masks()
+{
+	size_t i;
+	unsigned int numlock, scrolllock;
+	XModifierKeymap *map = XGetModifierMapping(dpy);
+	ROUNDTRIP(RT_GRAB_KEYS);
+
+	/* Mod2 is conventionally NumLock. */
+	if (!(numlock = keysym_mask(map, XK_Num_Lock)))
+		numlock = Mod2Mask;
+
+	scrolllock = keysym_mask(map, XK_Scroll_Lock);
+	XFreeModifiermap(map);
+
+	nr_lock_masks = 0;
+	for (i = 0; i < 8; i++) {
+		if ((i & 4) && (!scrolllock || scrolllock == numlock))
+			continue;
+
+		lock_masks[nr_lock_masks++] = ((i & 1) ? LockMask : 0) |
+					      ((i & 2) ? numlock : 0) |
+					      ((i & 4) ? scrolllock : 0);
+	}
+}
+
+static unsigned int mods_to_xmods(uint8_t mods)
+{
+	unsigned int xmods = 0;
 
 	if (mods & PLATFORM_MOD_CONTROL)
 		xmods |= ControlMask;
@@ -192,54 +399,111 @@ static void xgrab_key(uint8_t code, uint8_t mods, int grab)
 	if (mods & PLATFORM_MOD_ALT)
 		xmods |= Mod1Mask;
 
-	xerr_key = input_tostr(&(struct input_event){code, mods, 0});
+	return xmods;
+}
 
-	if (grab) {
-		XGrabKey(dpy, code, xmods, DefaultRootWindow(dpy), False,
-			 GrabModeAsync, GrabModeAsync);
+/*
+ * Replaces the set of grabbed activation keys using a single round trip.
+ * The keys stay grabbed until the next call, since an active keyboard
+ * grab takes precedence over them while a mode is running.
+ */
+static void set_grabbed_keys(struct input_event *events, size_t sz)
+{
+	size_t i, j;
+	Window root = DefaultRootWindow(dpy);
+
+	assert(sz <= MAX_GRAB_KEYS);
+
+	if (!nr_lock_masks)
+		init_lock_masks();
+
+	for (i = 0; i < nr_grabbed_keys; i++)
+		for (j = 0; j < nr_lock_masks; j++)
+			XUngrabKey(dpy, grabbed_keys[i].code,
+				   mods_to_xmods(grabbed_keys[i].mods) | lock_masks[j], root);
+
+	nr_grab_requests = 0;
+	nr_grabbed_keys = 0;
+
+	for (i = 0; i < sz; i++) {
+		if (!events[i].code)
+			continue;
 
-		XGrabKey(dpy, code, xmods | Mod2Mask, /* numlock */
-			 DefaultRootWindow(dpy), False, GrabModeAsync, GrabModeAsync);
-	} else {
-		XUngrabKey(dpy, code, xmods, DefaultRootWindow(dpy));
-		XUngrabKey(dpy, code, xmods | Mod2Mask, DefaultRootWindow(dpy));
+		grab_requests[nr_grab_requests].serial = NextRequest(dpy);
+		grab_requests[nr_grab_requests].ev = events[i];
+		grab_requests[nr_grab_requests].failed = 0;
+		nr_grab_requests++;
+
+		for (j = 0; j < nr_lock_masks; j++)
+			XGrabKey(dpy, events[i].code, mods_to_xmods(events[i].mods) | lock_masks[j],
+				 root, False, GrabModeAsync, GrabModeAsync);
+
+		grabbed_keys[nr_grabbed_keys++] = events[i];
 	}
 
+	XSetErrorHandler(input_xerr);
 	XSync(dpy, False);
-
+	ROUNDTRIP(RT_GRAB_KEYS);
 	XSetErrorHandler(NULL);
 }
 
+static int keys_grabbed(struct input_event *events, size_t sz)
+{
+	size_t i;
+	size_t n = 0;
+
+	for (i = 0; i < sz; i++) {
+		if (!events[i].code)
+			continue;
+
+		if (n == nr_grabbed_keys ||
+		    grabbed_keys[n].code != events[i].code ||
+		    grabbed_keys[n].mods != events[i].mods)
+			return 0;
+
+		n++;
+	}
+
+	return n == nr_grabbed_keys;
+}
+
 void x_input_grab_keyboard()
 {
-	int i, n;
-	XIDeviceInfo *devices;
+	size_t i;
+	uint8_t keymap[32];
+	uint64_t start;
 
 	if (nr_grabbed_device_ids != 0)
 		return;
 
-	devices = XIQueryDevice(dpy, XIAllDevices, &n);
+	start = get_real_time_us();
 
-	for (i = 0; i < n; i++) {
-		if (devices[i].use == XISlaveKeyboard ||
-		    devices[i].use == XIFloatingSlave) {
-			if (!strstr(devices[i].name, "XTEST") &&
-			    devices[i].enabled) {
-				int id = devices[i].deviceid;
+	process_pending_hierarchy_events();
+	update_keyboards();
 
-				grab(id);
-				grabbed_device_ids[nr_grabbed_device_ids++] =
-				    id;
-			}
-		}
-	}
+	for (i = 0; i < nr_keyboards; i++)
+		if (keyboards[i].enabled)
+			grabbed_device_ids[nr_grabbed_device_ids++] = keyboards[i].id;
+
+#ifdef WARPD_XCB
+	xcb_grab_keyboards(grabbed_device_ids, nr_grabbed_device_ids, keymap);
+#else
+	/* Xlib waits on the reply to each grab, XCB batches them. */
+	for (i = 0; i < (size_t)nr_grabbed_device_ids; i++)
+		grab(grabbed_device_ids[i]);
+
+	XQueryKeymap(dpy, (char *)keymap);
+	ROUNDTRIP(RT_GRAB_KEYBOARD);
+#endif
 
 	/* send a key up event for any depressed keys to avoid infinite repeat. */
-	reset_keyboard();
-	XIFreeDeviceInfo(devices);
+	release_keys(keymap);
 
+	x_track_pointer(1);
 	x_active_mods = 0;
-	XSync(dpy, False);
+
+	x_grab_time += get_real_time_us() - start;
+	x_nr_grabs++;
 }
 
 void x_input_ungrab_keyboard()
@@ -249,13 +513,9 @@ void x_input_ungrab_keyboard()
 	if (!nr_grabbed_device_ids)
 		return;
 
-	for (i = 0; i < nr_grabbed_device_ids; i++) {
-		int n;
-		XIDeviceInfo *info =
-		    XIQueryDevice(dpy, grabbed_device_ids[i], &n);
-
-		assert(n == 1);
+	process_pending_hierarchy_events();
 
+	for (i = 0; i < nr_grabbed_device_ids; i++) {
 		/*
 		 * NOTE: Attempting to ungrab a disabled xinput device
 		 * causes X to crash.
@@ -264,21 +524,15 @@ void x_input_ungrab_keyboard()
 		 * https://gitlab.freedesktop.org/xorg/lib/libxi/-/issues/11).
 		 *
 		 * This generally shouldn't happen unless the user
-		 * switches virtual terminals while warpd is running. We
-		 * used to explicitly check for this and perform weird
-		 * hacks to mitigate against it, but now we only grab
-		 * the keyboard when the program is in one if its
-		 * active modes which reduces the likelihood
-		 * sufficiently to not to warrant the additional
-		 * complexity.
+		 * switches virtual terminals while warpd is running,
+		 * in which case the hierarchy events will have told us.
 		 */
-
-		assert(info->enabled);
-		XIUngrabDevice(dpy, grabbed_device_ids[i], CurrentTime);
+		if (keyboard_enabled(grabbed_device_ids[i]))
+			XIUngrabDevice(dpy, grabbed_device_ids[i], CurrentTime);
 	}
 
 	nr_grabbed_device_ids = 0;
-	XSync(dpy, False);
+	x_track_pointer(0);
 }
 
 uint8_t xmods_to_mods(int xmods)
@@ -322,59 +576,59 @@ uint8_t get_code_modifier(uint8_t code)
 struct input_event *x_input_next_event(int timeout)
 {
 	static struct input_event ev;
-
-	struct timeval start, end;
-	gettimeofday(&start, NULL);
-	int elapsed = 0;
+	const uint64_t deadline = reactor_deadline(timeout);
 
 	while (1) {
 		int state;
+		int xmods;
 		uint8_t code;
 		XEvent *xev;
+		int ready = 0;
 
-		xev = get_next_xev(timeout - elapsed);
+		if (!(xev = get_next_xev(deadline, REACTOR_TIMERS, &ready))) {
+			if (ready & REACTOR_TIMERS)
+				return NULL;
 
-		if (xev) {
-			int xmods;
-			code = process_xinput_event(xev, &state, &xmods);
-			if (code && state != 2) {
-				ev.pressed = state;
-				ev.code = code;
-				ev.mods = xmods_to_mods(xmods);
-
-				if (state)
-					x_active_mods |= get_code_modifier(code);
-				else
-					x_active_mods &= ~get_code_modifier(code);
-
-				return &ev;
-			}
+			/* Interrupted by a keymap change. */
+			if (!deadline || reactor_now() < deadline)
+				continue;
+
+			return NULL;
 		}
 
-		if (timeout) {
-			gettimeofday(&end, NULL);
-			elapsed = (end.tv_sec - start.tv_sec) * 1000 +
-				  (end.tv_usec - start.tv_usec) / 1000;
+		code = process_xinput_event(xev, &state, &xmods);
+		if (code && state != 2) {
+			ev.pressed = state;
+			ev.code = code;
+			ev.mods = xmods_to_mods(xmods);
 
-			if (elapsed >= timeout)
-				return NULL;
+			if (state)
+				x_active_mods |= get_code_modifier(code);
+			else
+				x_active_mods &= ~get_code_modifier(code);
+
+			return &ev;
 		}
 	}
 }
 
 struct input_event *x_input_wait(struct input_event *events, size_t sz)
 {
-	size_t i;
 	static struct input_event ev;
 	struct input_evnet *ret = NULL;
 
-	for (i = 0; i < sz; i++) {
-		struct input_event *ev = &events[i];
-		xgrab_key(ev->code, ev->mods, 1);
-	}
+	/* Only regrab if the keys have changed (e.g on config reload). */
+	if (!keys_grabbed(events, sz))
+		set_grabbed_keys(events, sz);
+
+	keymap_updated = 0;
 
 	while (1) {
-		XEvent *xev = get_next_xev(100);
+		int ready = 0;
+
+		/* Only wake up periodically if there are files we can't watch. */
+		XEvent *xev = get_next_xev(nr_polled_files ? reactor_deadline(100) : 0,
+					   REACTOR_FILES | REACTOR_FDS, &ready);
 
 		if (xev && (xev->type == KeyPress || xev->type == KeyRelease)) {
 			ev.code = (uint8_t)xev->xkey.keycode;
@@ -385,32 +639,31 @@ struct input_event *x_input_wait(struct input_event *events, size_t sz)
 
 			ret = &ev;
 			goto exit;
-		} else {
-			size_t i;
-			for (i = 0; i < nr_monitored_files; i++) {
-				long mtime = x_get_mtime(monitored_files[i].path);
-				if (mtime != monitored_files[i].mtime) {
-					monitored_files[i].mtime = mtime;
-					goto exit;
-				}
-			}
 		}
-	}
 
-exit:
-	for (i = 0; i < sz; i++) {
-		struct input_event *ev = &events[i];
-		xgrab_key(ev->code, ev->mods, 0);
+		/* e.g hierarchy changes */
+		if (xev) {
+			int state, mods;
+			process_xinput_event(xev, &state, &mods);
+		}
+
+		if (ready & REACTOR_FDS)
+			goto exit;
+
+		/* The caller must re-resolve the supplied events. */
+		if (keymap_updated)
+			goto exit;
+
+		if (!xev && x_monitored_files_changed())
+			goto exit;
 	}
 
+exit:
 	return ret;
 }
 
 /* Normalize keynames for non API code. */
-struct {
-	const char *name;
-	const char *xname;
-} normalization_map[] = {
+static const struct key_alias normalization_map[] = {
 	{"esc", "Escape"},
 	{",", "comma"},
 	{".", "period"},
@@ -424,11 +677,41 @@ struct {
 	{"backspace", "BackSpace"},
 };
 
+/*
+ * (Re)builds the key name tables from Xlib's copy of the keymap. Level 0
+ * names are added first, mirroring XKeysymToKeycode()'s preference.
+ */
+static void update_keytable()
+{
+	int min, max;
+	int code, level;
+
+	XDisplayKeycodes(dpy, &min, &max);
+	keytable_reset(normalization_map, sizeof normalization_map / sizeof normalization_map[0]);
+
+	for (level = 0; level < 2; level++)
+		for (code = min; code <= max; code++) {
+			KeySym sym = XKeycodeToKeysym(dpy, code, level);
+
+			if (sym)
+				keytable_add(code, level, XKeysymToString(sym));
+		}
+}
+
+void init_keytable()
+{
+	update_keytable();
+}
+
 uint8_t x_input_lookup_code(const char *name, int *shifted)
 {
 	uint8_t code = 0;
 	size_t i;
 
+	if ((code = keytable_lookup_code(name, shifted)))
+		return code;
+
+	/* Fall back to Xlib for keysyms beyond the first two levels. */
 	for (i = 0; i < sizeof normalization_map / sizeof normalization_map[0]; i++)
 		if (!strcmp(normalization_map[i].name, name))
 			name = normalization_map[i].xname;
@@ -451,17 +734,5 @@ uint8_t x_input_lookup_code(const char *name, int *shifted)
 
 const char *x_input_lookup_name(uint8_t code, int shifted)
 {
-	size_t i;
-	const char *name;
-	KeySym sym = XKeycodeToKeysym(dpy, code, shifted);
-	if (!sym)
-		return NULL;
-
-	name = XKeysymToString(sym);
-
-	for (i = 0; i < sizeof normalization_map / sizeof normalization_map[0]; i++)
-		if (!strcmp(normalization_map[i].xname, name))
-			name = normalization_map[i].name;
-
-	return name;
+	return keytable_lookup_name(code, shifted);
 }
@@ -2,16 +2,39 @@
 
 static int hidden = 0;
 
+/*
+ * Pointer position model. While the keyboard is grabbed (i.e a mode is
+ * active) the position is tracked from our own motion requests, and
+ * invalidated by raw motion originating from any device other than XTEST.
+ * Outside of active modes, and whenever the model is invalid, the position
+ * is queried from the server.
+ */
+static struct {
+	int valid;
+	int tracking;
+
+	struct screen *scr;
+	int x;
+	int y;
+} ptr;
+
+static int xtest_pointer_id = -1;
+
+/*
+ * Pointer injection (and cursor visibility) requests are left in the output
+ * buffer and flushed by commit() (or the next event wait) so bursts of them
+ * can be pipelined. The server processes them in order, so e.g modifiers
+ * pressed for a click are guaranteed to be down when the button is.
+ */
+
 void x_mouse_up(int btn)
 {
 	XTestFakeButtonEvent(dpy, btn, False, CurrentTime);
-	XSync(dpy, False);
 }
 
 void x_mouse_down(int btn)
 {
 	XTestFakeButtonEvent(dpy, btn, True, CurrentTime);
-	XSync(dpy, False);
 }
 
 void x_mouse_click(int btn)
@@ -25,13 +48,9 @@ void x_mouse_click(int btn)
 	if (x_active_mods & PLATFORM_MOD_ALT)
 		XTestFakeKeyEvent(dpy, XKeysymToKeycode(dpy, XK_Alt_L), 1, CurrentTime);
 
-	XSync(dpy, False);
-
 	XTestFakeButtonEvent(dpy, btn, True, CurrentTime);
 	XTestFakeButtonEvent(dpy, btn, False, CurrentTime);
 
-	XSync(dpy, False);
-
 	if (x_active_mods & PLATFORM_MOD_SHIFT)
 		XTestFakeKeyEvent(dpy, XKeysymToKeycode(dpy, XK_Shift_L), 0, CurrentTime);
 	if (x_active_mods & PLATFORM_MOD_CONTROL)
@@ -40,8 +59,6 @@ void x_mouse_click(int btn)
 		XTestFakeKeyEvent(dpy, XKeysymToKeycode(dpy, XK_Meta_L), 0, CurrentTime);
 	if (x_active_mods & PLATFORM_MOD_ALT)
 		XTestFakeKeyEvent(dpy, XKeysymToKeycode(dpy, XK_Alt_L), 0, CurrentTime);
-
-	XSync(dpy, False);
 }
 
 void x_mouse_move(struct screen *scr, int x, int y)
@@ -50,10 +67,47 @@ void x_mouse_move(struct screen *scr, int x, int y)
 			     DefaultScreen(dpy),
 			     scr->x + x, scr->y + y, 0);
 
-	XSync(dpy, False);
+	/*
+	 * The server confines the pointer to the visible screen area, don't
+	 * try to predict where it ends up otherwise.
+	 */
+	if (ptr.tracking && x >= 0 && y >= 0 && x < scr->w && y < scr->h) {
+		ptr.scr = scr;
+		ptr.x = x;
+		ptr.y = y;
+		ptr.valid = 1;
+	} else {
+		ptr.valid = 0;
+	}
+}
+
+void x_process_raw_motion(XIRawEvent *ev)
+{
+	if (ev->sourceid != xtest_pointer_id)
+		ptr.valid = 0;
+}
+
+static Bool is_raw_motion(Display *dpy, XEvent *ev, XPointer arg)
+{
+	return ev->xcookie.type == GenericEvent &&
+	       ev->xcookie.extension == x_xi_opcode &&
+	       ev->xcookie.evtype == XI_RawMotion;
+}
+
+/* Accounts for any motion which has arrived but not yet been processed. */
+static void process_pending_motion()
+{
+	XEvent ev;
+
+	while (XCheckIfEvent(dpy, &ev, is_raw_motion, NULL)) {
+		if (XGetEventData(dpy, &ev.xcookie)) {
+			x_process_raw_motion(ev.xcookie.data);
+			XFreeEventData(dpy, &ev.xcookie);
+		}
+	}
 }
 
-void x_mouse_get_position(struct screen **_scr, int *_x, int *_y)
+static void query_pointer()
 {
 	size_t i;
 	Window chld, root;
@@ -64,20 +118,17 @@ void x_mouse_get_position(struct screen **_scr, int *_x, int *_y)
 	/* Obtain absolute pointer coordinates */
 	XQueryPointer(dpy, DefaultRootWindow(dpy), &root, &chld, &x, &y, &_, &_,
 		      &_u);
+	ROUNDTRIP(RT_POINTER);
 
 	for (i = 0; i < nr_xscreens; i++) {
 		struct screen *scr = &xscreens[i];
 
 		if ((x >= scr->x) && (x <= (scr->x + scr->w)) &&
 		    (y >= scr->y) && (y <= (scr->y + scr->h))) {
-			if (_scr)
-				*_scr = scr;
-
-			if (_x)
-				*_x = x - scr->x;
-
-			if (_y)
-				*_y = y - scr->y;
+			ptr.scr = scr;
+			ptr.x = x - scr->x;
+			ptr.y = y - scr->y;
+			ptr.valid = ptr.tracking;
 
 			return;
 		}
@@ -86,13 +137,72 @@ void x_mouse_get_position(struct screen **_scr, int *_x, int *_y)
 	assert(0);
 }
 
+void x_mouse_get_position(struct screen **scr, int *x, int *y)
+{
+	if (ptr.tracking)
+		process_pending_motion();
+
+	if (!ptr.valid)
+		query_pointer();
+
+	if (scr)
+		*scr = ptr.scr;
+	if (x)
+		*x = ptr.x;
+	if (y)
+		*y = ptr.y;
+}
+
+/* Starts (or stops) maintaining the position model. */
+void x_track_pointer(int enable)
+{
+	XIEventMask mask;
+	unsigned char bits[XIMaskLen(XI_LASTEVENT)] = {0};
+
+	if (ptr.tracking == enable)
+		return;
+
+	if (enable)
+		XISetMask(bits, XI_RawMotion);
+
+	mask.deviceid = XIAllMasterDevices;
+	mask.mask_len = sizeof bits;
+	mask.mask = bits;
+
+	XISelectEvents(dpy, DefaultRootWindow(dpy), &mask, 1);
+
+	ptr.tracking = enable;
+	ptr.valid = 0;
+}
+
+void init_pointer()
+{
+	int i, n;
+	int _;
+	XIDeviceInfo *devices;
+
+	if (!XQueryExtension(dpy, "XInputExtension", &x_xi_opcode, &_, &_)) {
+		fprintf(stderr, "FATAL: X Input extension not available.\n");
+		exit(-1);
+	}
+	ROUNDTRIP(RT_POINTER);
+
+	devices = XIQueryDevice(dpy, XIAllDevices, &n);
+	ROUNDTRIP(RT_POINTER);
+
+	for (i = 0; i < n; i++)
+		if (devices[i].use == XISlavePointer && strstr(devices[i].name, "XTEST"))
+			xtest_pointer_id = devices[i].deviceid;
+
+	XIFreeDeviceInfo(devices);
+}
+
 void x_mouse_hide()
 {
 	if (hidden)
 		return;
 
 	XFixesHideCursor(dpy, DefaultRootWindow(dpy));
-	XSync(dpy, False);
 	hidden = 1;
 }
 
@@ -102,6 +212,5 @@ void x_mouse_show()
 		return;
 
 	XFixesShowCursor(dpy, DefaultRootWindow(dpy));
-	XSync(dpy, False);
 	hidden = 0;
 }
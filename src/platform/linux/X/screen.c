@@ -3,9 +3,9 @@
 struct screen xscreens[32];
 size_t nr_xscreens = 0;
 
-static void window_set_color(Window w, const char *color)
+static void window_set_color(Window w, uint32_t color)
 {
-	uint32_t col = parse_xcolor(color, NULL);
+	uint32_t col = xcolor_pixel(color, NULL);
 
 	XSetWindowAttributes attr = {0};
 	attr.background_pixel = col;
@@ -14,36 +14,124 @@ static void window_set_color(Window w, const char *color)
 	XClearWindow(dpy, w);
 }
 
-void init_xscreens()
+/* Returns the refresh rate (in mHz) of the given mode. */
+int x_mode_refresh_rate(unsigned long dot_clock, unsigned int htotal,
+			unsigned int vtotal, unsigned long flags)
 {
-	Window chld, root;
-	int n, x, y, _;
-	unsigned int _u;
-	XineramaScreenInfo *screens;
+	double v = vtotal;
+
+	if (flags & RR_DoubleScan)
+		v *= 2;
+	if (flags & RR_Interlace)
+		v /= 2;
+
+	if (!htotal || !v)
+		return 0;
+
+	return (int)(dot_clock * 1000.0 / (htotal * v) + .5);
+}
+
+#ifndef WARPD_XCB
+/*
+ * Obtains the refresh rate of the CRTC driving each screen. Xlib blocks on
+ * every reply, so this costs one round trip for the resources and one per
+ * CRTC, shared by all screens (X_XCB=1 pipelines the CRTC queries).
+ */
+static void discover_refresh_rates(struct screen *screens, size_t n)
+{
+	int i, j;
+	size_t k;
+	int _;
+	XRRScreenResources *res;
+
+	for (k = 0; k < n; k++)
+		screens[k].refresh_rate = 0;
+
+	if (!XRRQueryExtension(dpy, &_, &_))
+		return;
+
+	res = XRRGetScreenResourcesCurrent(dpy, DefaultRootWindow(dpy));
+	ROUNDTRIP(RT_SCREENS);
+
+	if (!res)
+		return;
+
+	for (i = 0; i < res->ncrtc; i++) {
+		XRRCrtcInfo *crtc = XRRGetCrtcInfo(dpy, res, res->crtcs[i]);
+		ROUNDTRIP(RT_SCREENS);
+
+		if (!crtc)
+			continue;
+
+		for (k = 0; k < n && crtc->mode != None; k++) {
+			struct screen *scr = &screens[k];
+
+			if (scr->refresh_rate ||
+			    crtc->x != scr->x || crtc->y != scr->y ||
+			    (int)crtc->width != scr->w || (int)crtc->height != scr->h)
+				continue;
+
+			for (j = 0; j < res->nmode; j++) {
+				XRRModeInfo *mode = &res->modes[j];
+
+				if (mode->id == crtc->mode)
+					scr->refresh_rate = x_mode_refresh_rate(mode->dotClock,
+										mode->hTotal,
+										mode->vTotal,
+										mode->modeFlags);
+			}
+		}
+
+		XRRFreeCrtcInfo(crtc);
+	}
+
+	XRRFreeScreenResources(res);
+}
 
-	/* Obtain absolute pointer coordinates */
-	XQueryPointer(dpy, DefaultRootWindow(dpy), &root, &chld, &x, &y, &_, &_,
-		      &_u);
+static size_t query_screens(struct screen *xscreens, size_t max)
+{
+	int i, n;
+	XineramaScreenInfo *screens;
 
 	screens = XineramaQueryScreens(dpy, &n);
-	for (int i = 0; i < n; i++) {
-		size_t j;
+	ROUNDTRIP(RT_SCREENS);
 
-		struct screen *scr = &xscreens[nr_xscreens++];
+	for (i = 0; i < n && (size_t)i < max; i++) {
+		struct screen *scr = &xscreens[i];
 
 		scr->y = screens[i].y_org;
 		scr->x = screens[i].x_org;
 
 		scr->w = screens[i].width;
 		scr->h = screens[i].height;
+	}
+
+	XFree(screens);
+	discover_refresh_rates(xscreens, i);
+
+	return i;
+}
+#endif
+
+void init_xscreens()
+{
+	size_t i, j;
+
+#ifdef WARPD_XCB
+	nr_xscreens = xcb_query_screens(xscreens, sizeof xscreens / sizeof xscreens[0]);
+#else
+	nr_xscreens = query_screens(xscreens, sizeof xscreens / sizeof xscreens[0]);
+#endif
+
+	for (i = 0; i < nr_xscreens; i++) {
+		struct screen *scr = &xscreens[i];
 
 		for (j = 0; j < MAX_BOXES; j++) {
-			scr->boxes[j].win = create_window("#000000");
+			scr->boxes[j].win = create_window(0x000000FF);
+			scr->boxes[j].color = 0x000000FF;
 			XMapWindow(dpy, scr->boxes[j].win);
 		}
 	}
-
-	XFree(screens);
 }
 
 void x_screen_list(struct screen *rscreens[MAX_SCREENS], size_t *n)
@@ -62,6 +150,11 @@ void x_screen_get_dimensions(struct screen *scr, int *w, int *h)
 	*h = scr->h;
 }
 
+int x_screen_get_refresh_rate(struct screen *scr)
+{
+	return scr->refresh_rate;
+}
+
 void x_screen_clear(struct screen *scr)
 {
 	size_t i;
@@ -75,15 +168,15 @@ void x_screen_clear(struct screen *scr)
 	scr->nr_boxes = 0;
 }
 
-void x_screen_draw_box(struct screen *scr, int x, int y, int w, int h, const char *color)
+void x_screen_draw_box(struct screen *scr, int x, int y, int w, int h, uint32_t color)
 {
 	assert(scr->nr_boxes < MAX_BOXES);
 
 	struct box *box = &scr->boxes[scr->nr_boxes++];
 
-	if (strcmp(box->color, color)) {
+	if (box->color != color) {
 		window_set_color(box->win, color);
-		strcpy(box->color, color);
+		box->color = color;
 	};
 
 	XMoveResizeWindow(dpy, box->win, scr->x + x, scr->y + y, w, h);
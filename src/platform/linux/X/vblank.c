@@ -0,0 +1,70 @@
+/*
+ * Vblank notifications via the Present extension (see timer_arm_vblank in
+ * platform.h). Each screen has an unmapped window covering a point on its
+ * CRTC, on which a NotifyMSC request yields a CompleteNotify event at the
+ * next vblank. The timer to fire is carried in the request's serial.
+ */
+
+#include "X.h"
+
+/* -1 if the server doesn't support Present. */
+static int present_opcode = -1;
+
+void init_vblank()
+{
+	size_t i;
+	int event_base, error_base;
+
+	if (!XPresentQueryExtension(dpy, &present_opcode, &event_base, &error_base)) {
+		present_opcode = -1;
+		return;
+	}
+
+	for (i = 0; i < nr_xscreens; i++) {
+		struct screen *scr = &xscreens[i];
+		XSetWindowAttributes attrs;
+
+		attrs.override_redirect = True;
+
+		scr->vblankwin = XCreateWindow(dpy, DefaultRootWindow(dpy),
+					       scr->x + scr->w / 2, scr->y + scr->h / 2,
+					       1, 1, 0, 0, InputOnly, CopyFromParent,
+					       CWOverrideRedirect, &attrs);
+
+		XPresentSelectInput(dpy, scr->vblankwin, PresentCompleteNotifyMask);
+	}
+}
+
+int x_timer_arm_vblank(int timer, screen_t scr)
+{
+	if (present_opcode < 0)
+		return 0;
+
+	/*
+	 * A divisor of 1 targets the next MSC (i.e vblank) whatever the
+	 * current one is. The request is flushed by the next XPending().
+	 */
+	XPresentNotifyMSC(dpy, scr->vblankwin, timer, 0, 1, 0);
+	return 1;
+}
+
+/* Returns 1 if the event was a vblank notification, consuming it. */
+int x_process_vblank_event(XEvent *ev)
+{
+	XGenericEventCookie *cookie = &ev->xcookie;
+
+	if (present_opcode < 0 || cookie->type != GenericEvent ||
+	    cookie->extension != present_opcode)
+		return 0;
+
+	if (XGetEventData(dpy, cookie)) {
+		XPresentCompleteNotifyEvent *cn = cookie->data;
+
+		if (cookie->evtype == PresentCompleteNotify)
+			timer_fire(cn->serial_number);
+
+		XFreeEventData(dpy, cookie);
+	}
+
+	return 1;
+}
@@ -0,0 +1,228 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * XCB implementations of the backend's query heavy operations (X_XCB=1).
+ *
+ * Xlib blocks on the reply of each request as it is made, so e.g grabbing
+ * N keyboards or querying N CRTCs costs N round trips. Here all independent
+ * requests are issued up front and their cookies resolved afterwards,
+ * making each operation cost one round trip per dependency level. The
+ * connection is shared with Xlib (which still handles drawing, Xft and
+ * event delivery).
+ *
+ * This is deliberately a partial request path covering only the
+ * round-trip bound setup queries (atoms, screens and keyboard grabs). The
+ * per-frame hot paths (pointer warps, CopyArea, shape updates) are
+ * reply-less requests which Xlib already buffers and flushes once per
+ * frame, so XCB gains nothing there, and moving event delivery over would
+ * require taking ownership of the event queue away from Xlib.
+ */
+
+#include "X.h"
+
+#include <X11/Xlib-xcb.h>
+#include <xcb/randr.h>
+#include <xcb/xinerama.h>
+#include <xcb/xinput.h>
+
+#define MAX_CRTCS 32
+
+static xcb_connection_t *conn;
+static xcb_window_t root;
+
+static int has_randr;
+
+void xcb_init()
+{
+	int major = 2, minor = 0;
+
+	conn = XGetXCBConnection(dpy);
+	root = DefaultRootWindow(dpy);
+
+	/* Resolve all the extensions we need in a single round trip. */
+	xcb_prefetch_extension_data(conn, &xcb_xinerama_id);
+	xcb_prefetch_extension_data(conn, &xcb_randr_id);
+	xcb_prefetch_extension_data(conn, &xcb_input_id);
+
+	if (!xcb_get_extension_data(conn, &xcb_input_id)->present) {
+		fprintf(stderr, "FATAL: X Input extension not available.\n");
+		exit(-1);
+	}
+
+	has_randr = xcb_get_extension_data(conn, &xcb_randr_id)->present;
+	ROUNDTRIP(RT_SCREENS);
+
+	/*
+	 * Announce our XI2 version through libXi, which also needs to be
+	 * initialized in order to decode the XI events delivered by Xlib.
+	 */
+	XIQueryVersion(dpy, &major, &minor);
+	ROUNDTRIP(RT_GRAB_KEYBOARD);
+}
+
+void xcb_intern_atoms(char *names[], Atom atoms[], size_t n)
+{
+	size_t i;
+	xcb_intern_atom_cookie_t cookies[n];
+
+	for (i = 0; i < n; i++)
+		cookies[i] = xcb_intern_atom(conn, 0, strlen(names[i]), names[i]);
+
+	for (i = 0; i < n; i++) {
+		xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(conn, cookies[i], NULL);
+
+		atoms[i] = reply ? reply->atom : None;
+		free(reply);
+	}
+}
+
+static int crtc_refresh_rate(xcb_randr_get_screen_resources_current_reply_t *res,
+			     xcb_randr_get_crtc_info_reply_t *crtc)
+{
+	int i;
+	xcb_randr_mode_info_t *modes = xcb_randr_get_screen_resources_current_modes(res);
+	int nr_modes = xcb_randr_get_screen_resources_current_modes_length(res);
+
+	for (i = 0; i < nr_modes; i++)
+		if (modes[i].id == crtc->mode)
+			return x_mode_refresh_rate(modes[i].dot_clock,
+						   modes[i].htotal,
+						   modes[i].vtotal,
+						   modes[i].mode_flags);
+
+	return 0;
+}
+
+/*
+ * Populates the geometry and refresh rate of each screen. Costs two round
+ * trips irrespective of the number of screens and CRTCs.
+ */
+size_t xcb_query_screens(struct screen *screens, size_t max)
+{
+	int i, j;
+	size_t n = 0;
+
+	xcb_xinerama_query_screens_reply_t *xin;
+	xcb_xinerama_screen_info_t *info;
+	xcb_xinerama_query_screens_cookie_t xin_cookie;
+
+	xcb_randr_get_screen_resources_current_reply_t *res = NULL;
+	xcb_randr_get_screen_resources_current_cookie_t res_cookie;
+
+	xcb_randr_get_crtc_info_reply_t *crtcs[MAX_CRTCS] = {0};
+	xcb_randr_get_crtc_info_cookie_t crtc_cookies[MAX_CRTCS];
+	xcb_randr_crtc_t *crtc_ids;
+	int nr_crtcs = 0;
+
+	xin_cookie = xcb_xinerama_query_screens(conn);
+	if (has_randr)
+		res_cookie = xcb_randr_get_screen_resources_current(conn, root);
+
+	xin = xcb_xinerama_query_screens_reply(conn, xin_cookie, NULL);
+	if (has_randr)
+		res = xcb_randr_get_screen_resources_current_reply(conn, res_cookie, NULL);
+	ROUNDTRIP(RT_SCREENS);
+
+	if (!xin) {
+		fprintf(stderr, "FATAL: Failed to query screens\n");
+		exit(-1);
+	}
+
+	if (res) {
+		crtc_ids = xcb_randr_get_screen_resources_current_crtcs(res);
+		nr_crtcs = xcb_randr_get_screen_resources_current_crtcs_length(res);
+
+		if (nr_crtcs > MAX_CRTCS)
+			nr_crtcs = MAX_CRTCS;
+
+		for (i = 0; i < nr_crtcs; i++)
+			crtc_cookies[i] = xcb_randr_get_crtc_info(conn, crtc_ids[i],
+								  res->config_timestamp);
+
+		for (i = 0; i < nr_crtcs; i++)
+			crtcs[i] = xcb_randr_get_crtc_info_reply(conn, crtc_cookies[i], NULL);
+		ROUNDTRIP(RT_SCREENS);
+	}
+
+	info = xcb_xinerama_query_screens_screen_info(xin);
+	for (i = 0; i < xcb_xinerama_query_screens_screen_info_length(xin) && n < max; i++) {
+		struct screen *scr = &screens[n++];
+
+		scr->x = info[i].x_org;
+		scr->y = info[i].y_org;
+		scr->w = info[i].width;
+		scr->h = info[i].height;
+		scr->refresh_rate = 0;
+
+		for (j = 0; j < nr_crtcs; j++) {
+			xcb_randr_get_crtc_info_reply_t *crtc = crtcs[j];
+
+			if (crtc && crtc->mode != XCB_NONE &&
+			    crtc->x == scr->x && crtc->y == scr->y &&
+			    crtc->width == scr->w && crtc->height == scr->h) {
+				scr->refresh_rate = crtc_refresh_rate(res, crtc);
+				break;
+			}
+		}
+	}
+
+	for (i = 0; i < nr_crtcs; i++)
+		free(crtcs[i]);
+
+	free(res);
+	free(xin);
+
+	return n;
+}
+
+/*
+ * Grabs the supplied keyboards and obtains the keymap as it was at the
+ * time of the grab. Costs a single round trip irrespective of the number
+ * of keyboards.
+ */
+void xcb_grab_keyboards(const int ids[], size_t n, uint8_t keymap[32])
+{
+	size_t i;
+	const uint32_t mask = XCB_INPUT_XI_EVENT_MASK_KEY_PRESS |
+			      XCB_INPUT_XI_EVENT_MASK_KEY_RELEASE;
+
+	xcb_input_xi_grab_device_cookie_t cookies[n ? n : 1];
+	xcb_query_keymap_cookie_t keymap_cookie;
+	xcb_query_keymap_reply_t *keymap_reply;
+
+	for (i = 0; i < n; i++)
+		cookies[i] = xcb_input_xi_grab_device(conn, root, XCB_CURRENT_TIME,
+						      XCB_NONE, ids[i],
+						      XCB_INPUT_GRAB_MODE_22_ASYNC,
+						      XCB_INPUT_GRAB_MODE_22_ASYNC,
+						      0, 1, &mask);
+
+	keymap_cookie = xcb_query_keymap(conn);
+
+	for (i = 0; i < n; i++) {
+		xcb_input_xi_grab_device_reply_t *reply =
+			xcb_input_xi_grab_device_reply(conn, cookies[i], NULL);
+
+		if (!reply || reply->status) {
+			fprintf(stderr, "FATAL: Failed to grab keyboard %d: %d\n",
+				ids[i], reply ? reply->status : -1);
+			exit(-1);
+		}
+
+		free(reply);
+	}
+
+	keymap_reply = xcb_query_keymap_reply(conn, keymap_cookie, NULL);
+	ROUNDTRIP(RT_GRAB_KEYBOARD);
+
+	if (keymap_reply)
+		memcpy(keymap, keymap_reply->keys, 32);
+	else
+		memset(keymap, 0, 32);
+
+	free(keymap_reply);
+}
@@ -0,0 +1,83 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * A queue of key events, filled while the backend reads from its input
+ * source (e.g a Wayland dispatch) and drained by input_next_events.
+ *
+ * Backends only refill the queue once it has been drained, so it never
+ * holds more than a single read's worth of events (e.g the contents of the
+ * Wayland connection buffer). Rather than dropping input when a burst (a
+ * macro keyboard, a paste) exceeds the initial size, the ring doubles in
+ * size. head and tail are free running and masked on access.
+ */
+
+#include "inputq.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Must be a power of two. */
+#define INPUTQ_INITIAL_SZ 256
+
+static struct input_event *queue;
+static uint32_t sz;
+static uint32_t head;
+static uint32_t tail;
+
+/* Doubles the ring, unwrapping its contents to the start of the new one. */
+static void grow()
+{
+	uint32_t i;
+	const uint32_t n = tail - head;
+	const uint32_t new_sz = sz ? sz * 2 : INPUTQ_INITIAL_SZ;
+	struct input_event *new_queue = malloc(new_sz * sizeof queue[0]);
+
+	if (!new_queue) {
+		fprintf(stderr, "FATAL: Failed to grow the input queue\n");
+		exit(-1);
+	}
+
+	for (i = 0; i < n; i++)
+		new_queue[i] = queue[(head + i) & (sz - 1)];
+
+	free(queue);
+
+	queue = new_queue;
+	sz = new_sz;
+	head = 0;
+	tail = n;
+}
+
+void inputq_push(uint8_t code, uint8_t pressed, uint8_t mods)
+{
+	struct input_event *ev;
+
+	if (tail - head == sz)
+		grow();
+
+	ev = &queue[tail++ & (sz - 1)];
+
+	ev->code = code;
+	ev->pressed = pressed;
+	ev->mods = mods;
+}
+
+/* Copies up to n events into evs, returns the number copied. */
+size_t inputq_pop(struct input_event *evs, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n && head != tail; i++)
+		evs[i] = queue[head++ & (sz - 1)];
+
+	return i;
+}
+
+int inputq_empty()
+{
+	return head == tail;
+}
@@ -0,0 +1,19 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+#ifndef INPUTQ_H
+#define INPUTQ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../platform.h"
+
+void inputq_push(uint8_t code, uint8_t pressed, uint8_t mods);
+size_t inputq_pop(struct input_event *evs, size_t n);
+int inputq_empty();
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * Key name <-> code tables for the current keymap, shared by the X and
+ * Wayland backends.
+ *
+ * Names are looked up every time a config key is matched and every time a
+ * key is converted to a string, so rather than scanning the keymap and the
+ * alias list on each lookup, the backend rebuilds the tables whenever it
+ * receives a keymap: code -> name is a plain array for each shift level and
+ * name -> code is an open addressed hash containing both the keysym name
+ * and the warpd name of each key.
+ */
+
+#include "keytable.h"
+
+#include <string.h>
+
+#define MAX_NAME 32
+
+/* Must be a power of two larger than the maximum number of names (1024). */
+#define NR_SLOTS 2048
+
+static char xnames[2][256][MAX_NAME];
+static const char *names[2][256];
+
+static struct {
+	const char *key;
+	uint8_t code;
+	uint8_t shifted;
+} slots[NR_SLOTS];
+
+static const struct key_alias *aliases;
+static size_t nr_aliases;
+
+/* FNV-1a */
+static uint32_t hash(const char *s)
+{
+	uint32_t h = 2166136261u;
+
+	while (*s) {
+		h ^= (uint8_t)*s++;
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+static void insert(const char *key, uint8_t code, int shifted)
+{
+	uint32_t i = hash(key) & (NR_SLOTS - 1);
+
+	while (slots[i].key) {
+		/* Like a keymap scan, the first key to claim a name keeps it. */
+		if (!strcmp(slots[i].key, key))
+			return;
+
+		i = (i + 1) & (NR_SLOTS - 1);
+	}
+
+	slots[i].key = key;
+	slots[i].code = code;
+	slots[i].shifted = shifted;
+}
+
+/* Invalidates the tables, to be followed by a keytable_add() for each key. */
+void keytable_reset(const struct key_alias *map, size_t n)
+{
+	memset(slots, 0, sizeof slots);
+	memset(names, 0, sizeof names);
+
+	aliases = map;
+	nr_aliases = n;
+}
+
+/*
+ * Adds the keysym name of the given code at the given shift level. Should
+ * be called at most once for each code and level after a reset, keys added
+ * first take precedence in keytable_lookup_code().
+ */
+void keytable_add(uint8_t code, int shifted, const char *xname)
+{
+	size_t i;
+	char *s;
+
+	if (!xname || !xname[0])
+		return;
+
+	shifted = !!shifted;
+	s = xnames[shifted][code];
+
+	strncpy(s, xname, MAX_NAME - 1);
+	s[MAX_NAME - 1] = 0;
+
+	names[shifted][code] = s;
+	for (i = 0; i < nr_aliases; i++)
+		if (!strcmp(aliases[i].xname, s))
+			names[shifted][code] = aliases[i].name;
+
+	insert(s, code, shifted);
+	if (names[shifted][code] != s)
+		insert(names[shifted][code], code, shifted);
+}
+
+/* Accepts both warpd and keysym names, returns 0 if the name is unknown. */
+uint8_t keytable_lookup_code(const char *name, int *shifted)
+{
+	uint32_t i = hash(name) & (NR_SLOTS - 1);
+
+	while (slots[i].key) {
+		if (!strcmp(slots[i].key, name)) {
+			*shifted = slots[i].shifted;
+			return slots[i].code;
+		}
+
+		i = (i + 1) & (NR_SLOTS - 1);
+	}
+
+	return 0;
+}
+
+/* Returns the (warpd) name of the key, or NULL if it has none. */
+const char *keytable_lookup_name(uint8_t code, int shifted)
+{
+	return names[!!shifted][code];
+}
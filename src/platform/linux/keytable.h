@@ -0,0 +1,25 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+#ifndef KEYTABLE_H
+#define KEYTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Maps a warpd key name onto the keysym name it stands for. */
+struct key_alias {
+	const char *name;
+	const char *xname;
+};
+
+void keytable_reset(const struct key_alias *aliases, size_t n);
+void keytable_add(uint8_t code, int shifted, const char *xname);
+
+uint8_t keytable_lookup_code(const char *name, int *shifted);
+const char *keytable_lookup_name(uint8_t code, int shifted);
+
+#endif
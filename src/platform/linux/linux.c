@@ -23,7 +23,7 @@ void wayland_init()
 
 void platform_run(int (*main) (struct platform *platform))
 {
-	struct platform platform;
+	static struct platform platform;
 
 	if (getenv("WAYLAND_DISPLAY"))
 		wayland_init(&platform);
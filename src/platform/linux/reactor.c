@@ -0,0 +1,256 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * The event loop shared by the X and Wayland backends.
+ *
+ * Backends register their fds (display connection, file monitor, IPC
+ * socket) under a source and wait on any subset of the sources with an
+ * optional absolute deadline. The deadline is armed on a timerfd, so it
+ * doesn't have to be recomputed each time the wait is interrupted by
+ * something which isn't of interest to the caller (e.g an X reply).
+ *
+ * Long lived timers (e.g the core's frame and blink timers) get a timerfd
+ * of their own under REACTOR_TIMERS, so they stay armed across waits
+ * instead of being folded into each wait's deadline.
+ */
+
+#include "reactor.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_FDS 16
+#define MAX_TIMERS 8
+
+static int epfd = -1;
+static int tfd = -1;
+
+static struct {
+	int fd;
+	int source;
+} fds[MAX_FDS];
+static size_t nr_fds;
+
+/* The sources currently enabled in the epoll set. */
+static int enabled_sources;
+
+/* The deadline the timerfd is currently armed with (0 if disarmed). */
+static uint64_t armed;
+
+static struct {
+	int fd;
+	uint64_t deadline;
+} timers[MAX_TIMERS];
+
+static void ctl(int op, int fd, uint32_t events, uint32_t data)
+{
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof ev);
+	ev.events = events;
+	ev.data.u32 = data;
+
+	if (epoll_ctl(epfd, op, fd, &ev) < 0) {
+		perror("epoll_ctl");
+		exit(-1);
+	}
+}
+
+static void init()
+{
+	if (epfd >= 0)
+		return;
+
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (epfd < 0 || tfd < 0) {
+		fprintf(stderr, "FATAL: Failed to initialize the event loop: %s\n",
+			strerror(errno));
+		exit(-1);
+	}
+
+	/* Sources are bit flags, so 0 identifies the timer. */
+	ctl(EPOLL_CTL_ADD, tfd, EPOLLIN, 0);
+}
+
+void reactor_add_fd(int fd, int source)
+{
+	init();
+
+	if (nr_fds == MAX_FDS) {
+		fprintf(stderr, "FATAL: Too many monitored fds\n");
+		exit(-1);
+	}
+
+	fds[nr_fds].fd = fd;
+	fds[nr_fds].source = source;
+	nr_fds++;
+
+	ctl(EPOLL_CTL_ADD, fd, (enabled_sources & source) ? EPOLLIN : 0, source);
+}
+
+uint64_t reactor_now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/* Converts a timeout in ms (0 meaning none) into a deadline. */
+uint64_t reactor_deadline(int timeout)
+{
+	return timeout > 0 ? reactor_now() + timeout * 1000ULL : 0;
+}
+
+/*
+ * Fds belonging to disabled sources stay in the epoll set (with no events),
+ * so they don't wake us up while they are of no interest to the caller.
+ */
+static void enable_sources(int sources)
+{
+	size_t i;
+
+	if (sources == enabled_sources)
+		return;
+
+	for (i = 0; i < nr_fds; i++)
+		ctl(EPOLL_CTL_MOD, fds[i].fd,
+		    (fds[i].source & sources) ? EPOLLIN : 0, fds[i].source);
+
+	enabled_sources = sources;
+}
+
+static void settime(int fd, uint64_t deadline)
+{
+	struct itimerspec its;
+
+	/* A zeroed it_value disarms the timer. */
+	memset(&its, 0, sizeof its);
+	its.it_value.tv_sec = deadline / 1000000;
+	its.it_value.tv_nsec = (deadline % 1000000) * 1000;
+
+	if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+		perror("timerfd_settime");
+		exit(-1);
+	}
+}
+
+static void arm(uint64_t deadline)
+{
+	if (deadline == armed)
+		return;
+
+	settime(tfd, deadline);
+	armed = deadline;
+}
+
+/*
+ * Arms the given timer with an absolute deadline (in reactor_now() time),
+ * or disarms it if the deadline is 0. Expiry makes REACTOR_TIMERS readable
+ * until the timer is re-armed or the expiry is consumed by reactor_wait().
+ */
+void reactor_timer_set(int id, uint64_t deadline)
+{
+	if (id < 0 || id >= MAX_TIMERS) {
+		fprintf(stderr, "FATAL: Invalid timer %d\n", id);
+		exit(-1);
+	}
+
+	if (!timers[id].fd) {
+		/* Don't create a timerfd just to disarm it. */
+		if (!deadline)
+			return;
+
+		timers[id].fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (timers[id].fd < 0) {
+			perror("timerfd_create");
+			exit(-1);
+		}
+
+		reactor_add_fd(timers[id].fd, REACTOR_TIMERS);
+	}
+
+	if (deadline == timers[id].deadline)
+		return;
+
+	settime(timers[id].fd, deadline);
+	timers[id].deadline = deadline;
+}
+
+/* Consumes the expiry of every timer which has fired. */
+static void clear_timers()
+{
+	size_t i;
+
+	for (i = 0; i < MAX_TIMERS; i++) {
+		uint64_t count;
+
+		if (timers[i].fd &&
+		    read(timers[i].fd, &count, sizeof count) == sizeof count)
+			timers[i].deadline = 0;
+	}
+}
+
+/*
+ * Blocks until at least one of the supplied sources is readable or the
+ * deadline (if non zero) has passed. Returns the set of readable sources,
+ * or 0 if the deadline passed first.
+ */
+int reactor_wait(int sources, uint64_t deadline)
+{
+	struct epoll_event events[MAX_FDS + 1];
+
+	init();
+	enable_sources(sources);
+	arm(deadline);
+
+	while (1) {
+		int i, n;
+		int ready = 0;
+		int expired = 0;
+
+		n = epoll_wait(epfd, events, sizeof events / sizeof events[0], -1);
+
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			perror("epoll_wait");
+			exit(-1);
+		}
+
+		for (i = 0; i < n; i++) {
+			if (events[i].data.u32 == 0) {
+				uint64_t count;
+
+				if (read(tfd, &count, sizeof count) == sizeof count) {
+					expired = 1;
+					armed = 0;
+				}
+			} else {
+				ready |= events[i].data.u32;
+			}
+		}
+
+		if (ready & REACTOR_TIMERS)
+			clear_timers();
+
+		if (ready)
+			return ready;
+
+		if (expired)
+			return 0;
+	}
+}
@@ -0,0 +1,28 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <stdint.h>
+
+/* Event sources, a backend may register any number of fds under each. */
+enum {
+	REACTOR_DISPLAY = 0x1,
+	REACTOR_FILES = 0x2,
+	REACTOR_FDS = 0x4,
+	REACTOR_TIMERS = 0x8,
+};
+
+void reactor_add_fd(int fd, int source);
+
+uint64_t reactor_now();
+uint64_t reactor_deadline(int timeout);
+
+int reactor_wait(int sources, uint64_t deadline);
+void reactor_timer_set(int id, uint64_t deadline);
+
+#endif
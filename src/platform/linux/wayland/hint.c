@@ -5,50 +5,110 @@
  */
 #include "wayland.h"
 
-static char bgcolor[16];
-static char fgcolor[16];
-static const char *font_family;
+static double bgcolor[4];
+static double fgcolor[4];
+static char font_family[256];
 
-static int calculate_font_size(cairo_t *cr, int w, int h)
+/*
+ * Fonts sized to fit a given hint box. Solving for the size is expensive, so
+ * it is only done once per (font, w, h).
+ */
+#define MAX_CACHED_FONTS 8
+
+static struct {
+	int w;
+	int h;
+	cairo_scaled_font_t *font;
+} font_cache[MAX_CACHED_FONTS];
+
+static size_t font_cache_next;
+
+static void flush_font_cache()
 {
-	cairo_text_extents_t extents;
-	size_t sz = 100;
+	size_t i;
 
-	cairo_select_font_face (cr,
-				font_family,
-				CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+	for (i = 0; i < MAX_CACHED_FONTS; i++) {
+		if (font_cache[i].font)
+			cairo_scaled_font_destroy(font_cache[i].font);
+
+		font_cache[i].font = NULL;
+	}
+}
 
-	do {
-		cairo_set_font_size(cr, sz);
-		cairo_text_extents(cr, "WW", &extents);
-		sz--;
-	} while (extents.height > h || extents.width > w);
+static int text_fits(cairo_t *cr, int sz, int w, int h)
+{
+	cairo_text_extents_t extents;
 
-	return sz;
+	cairo_set_font_size(cr, sz);
+	cairo_text_extents(cr, "WW", &extents);
+
+	return extents.height <= h && extents.width <= w;
 }
 
-static void cairo_draw_text(cairo_t *cr, const char *s, int x, int y, int w, int h)
+static cairo_scaled_font_t *get_font(cairo_t *cr, int w, int h)
 {
-	int ptsz = calculate_font_size(cr, w, h);
+	size_t i;
+	int lo = 1;
+	int hi = 100;
+
+	for (i = 0; i < MAX_CACHED_FONTS; i++) {
+		if (font_cache[i].font && font_cache[i].w == w && font_cache[i].h == h)
+			return font_cache[i].font;
+	}
 
 	cairo_select_font_face (cr,
 				font_family,
 				CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
 
+	/* Find the largest size (up to 100) at which the text fits. */
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+
+		if (text_fits(cr, mid, w, h))
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	/* Keep the one point margin of the old linear search. */
+	cairo_set_font_size(cr, lo > 1 ? lo - 1 : 1);
+
+	i = font_cache_next;
+	font_cache_next = (font_cache_next + 1) % MAX_CACHED_FONTS;
+
+	if (font_cache[i].font)
+		cairo_scaled_font_destroy(font_cache[i].font);
+
+	font_cache[i].w = w;
+	font_cache[i].h = h;
+	font_cache[i].font = cairo_scaled_font_reference(cairo_get_scaled_font(cr));
+
+	return font_cache[i].font;
+}
+
+static void cairo_draw_text(cairo_t *cr, const char *s, int x, int y, int w, int h)
+{
 	cairo_text_extents_t extents;
-	cairo_set_font_size(cr, ptsz);
+	cairo_scaled_font_t *font = get_font(cr, w, h);
 
-	cairo_text_extents(cr, s, &extents);
+	cairo_set_scaled_font(cr, font);
+	cairo_scaled_font_text_extents(font, s, &extents);
 
 	cairo_move_to(cr, x + (w-extents.width)/2, y-extents.y_bearing + (h-extents.height)/2);
 	cairo_show_text(cr, s);
 }
 
+static void unpack_color(uint32_t rgba, double color[4])
+{
+	color[0] = (rgba >> 24) / 255.0;
+	color[1] = ((rgba >> 16) & 0xFF) / 255.0;
+	color[2] = ((rgba >> 8) & 0xFF) / 255.0;
+	color[3] = (rgba & 0xFF) / 255.0;
+}
+
 void way_hint_draw(struct screen *scr, struct hint *hints, size_t n)
 {
 	size_t i;
-	uint8_t r,g,b,a;
-
 	cairo_t *cr = scr->cr;
 
 	if (scr->hints)
@@ -59,16 +119,14 @@ void way_hint_draw(struct screen *scr, struct hint *hints, size_t n)
 	cairo_paint(cr);
 
 	for (i = 0; i < n; i++) {
-		way_hex_to_rgba(bgcolor, &r, &g, &b, &a);
-		cairo_set_source_rgba(cr, r / 255.0, g / 255.0, b / 255.0,
-				      a / 255.0);
+		cairo_set_source_rgba(cr, bgcolor[0], bgcolor[1], bgcolor[2],
+				      bgcolor[3]);
 		cairo_rectangle(cr, hints[i].x, hints[i].y, hints[i].w,
 				hints[i].h);
 		cairo_fill(cr);
 
-		way_hex_to_rgba(fgcolor, &r, &g, &b, &a);
-		cairo_set_source_rgba(cr, r / 255.0, g / 255.0, b / 255.0,
-				      a / 255.0);
+		cairo_set_source_rgba(cr, fgcolor[0], fgcolor[1], fgcolor[2],
+				      fgcolor[3]);
 
 		cairo_draw_text(cr, hints[i].label, hints[i].x, hints[i].y,
 				hints[i].w, hints[i].h);
@@ -77,12 +135,40 @@ void way_hint_draw(struct screen *scr, struct hint *hints, size_t n)
 	scr->hints = create_surface(scr, 0, 0, scr->w, scr->h, 0);
 }
 
-void way_init_hint(const char *bg, const char *fg, int border_radius, const char *font)
+/*
+ * Clear the removed hints in the existing buffer and damage just those
+ * regions rather than repainting the screen and creating a new surface.
+ */
+void way_hint_update(struct screen *scr, struct hint *removed, size_t n)
+{
+	size_t i;
+	cairo_t *cr = scr->cr;
+
+	if (!scr->hints)
+		return;
+
+	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_rgba(cr, 0, 0, 0, 0);
+
+	for (i = 0; i < n; i++) {
+		cairo_rectangle(cr, removed[i].x, removed[i].y,
+				removed[i].w, removed[i].h);
+		cairo_fill(cr);
+
+		surface_damage(scr->hints, removed[i].x, removed[i].y,
+			       removed[i].w, removed[i].h);
+	}
+
+	surface_commit(scr->hints);
+}
+
+void way_init_hint(uint32_t bg, uint32_t fg, int border_radius, const char *font)
 {
-	strncpy(bgcolor, bg, sizeof bgcolor);
-	strncpy(fgcolor, fg, sizeof fgcolor);
+	unpack_color(bg, bgcolor);
+	unpack_color(fg, fgcolor);
 
 	//TODO: handle border radius
 
-	font_family = font;
+	snprintf(font_family, sizeof font_family, "%s", font);
+	flush_font_cache();
 }
@@ -5,13 +5,20 @@
  */
 #include "wayland.h"
 
-static struct input_event input_queue[32];
-static size_t input_queue_sz;
-
 static uint8_t x_active_mods = 0;
 
 static void noop() {}
-struct keymap_entry keymap[256] = {0};
+
+static const struct key_alias normalization_map[] = {
+	{"esc", "Escape"},
+	{",", "comma"},
+	{".", "period"},
+	{"-", "minus"},
+	{"/", "slash"},
+	{";", "semicolon"},
+	{"$", "dollar"},
+	{"backspace", "BackSpace"},
+};
 
 static void update_mods(uint8_t code, uint8_t pressed)
 {
@@ -54,21 +61,18 @@ static void handle_key(void *data,
 		       uint32_t serial,
 		       uint32_t time, uint32_t code, uint32_t state)
 {
-	struct input_event *ev = &input_queue[input_queue_sz++];
-
 	update_mods(code, state);
-
-	ev->code = code;
-	ev->pressed = state;
-	ev->mods = x_active_mods;
+	inputq_push(code, state, x_active_mods);
 }
 
+/* Sent on startup and whenever the layout changes. */
 static void handle_keymap(void *data,
 			  struct wl_keyboard *wl_keyboard,
 			  uint32_t format, int32_t fd, uint32_t size)
 {
 	size_t i;
 	char *buf;
+	char name[32];
 	struct xkb_context *ctx;
 	struct xkb_keymap *xkbmap;
 	struct xkb_state *xkbstate;
@@ -87,24 +91,33 @@ static void handle_keymap(void *data,
 	xkbstate = xkb_state_new(xkbmap);
 	assert(xkbstate);
 
+	munmap(buf, size);
+	close(fd);
+
+	keytable_reset(normalization_map, sizeof normalization_map / sizeof normalization_map[0]);
+
 	for (i = 0; i < 248; i++) {
 		const xkb_keysym_t *syms;
 		if (xkb_keymap_key_get_syms_by_level(xkbmap, i+8,
 						     xkb_state_key_get_layout(xkbstate, i+8),
 						     0, &syms)) {
-			xkb_keysym_get_name(syms[0], keymap[i].name, sizeof keymap[i].name);
+			if (xkb_keysym_get_name(syms[0], name, sizeof name) > 0)
+				keytable_add(i, 0, name);
 		}
 
 		if (xkb_keymap_key_get_syms_by_level(xkbmap, i+8,
 						     xkb_state_key_get_layout(xkbstate, i+8),
 						     1,
 						     &syms)) {
-			xkb_keysym_get_name(syms[0], keymap[i].shifted_name, sizeof keymap[i].shifted_name);
+			if (xkb_keysym_get_name(syms[0], name, sizeof name) > 0)
+				keytable_add(i, 1, name);
 		}
 	}
 	xkb_state_unref(xkbstate);
 	xkb_keymap_unref(xkbmap);
 	xkb_context_unref(ctx);
+
+	config_keymap_changed();
 }
 
 static int input_grabbed = 0;
@@ -161,30 +174,40 @@ void way_input_ungrab_keyboard()
 }
 
 
-struct input_event *way_input_next_event(int timeout)
+/*
+ * Copies up to n queued events into evs, blocking until at least one is
+ * available or the timeout (in ms, 0 for none) expires. Returns the number
+ * of events copied (0 on timeout).
+ *
+ * The display is only dispatched once the queue is empty, so a burst
+ * which arrived in a single wakeup is handed out without further syscalls.
+ */
+size_t way_input_next_events(struct input_event *evs, size_t n, int timeout)
 {
-	static struct input_event ev;
+	const uint64_t deadline = reactor_deadline(timeout);
 
-	struct pollfd pfds[] = {
-		{ .fd = wl_display_get_fd(wl.dpy), .events = POLLIN },
-	};
+	wl_display_flush(wl.dpy);
 
-	while (1) {
-		wl_display_flush(wl.dpy);
+	while (inputq_empty()) {
 		wl_display_dispatch_pending(wl.dpy);
-		if (input_queue_sz) {
-			input_queue_sz--;
-			ev = input_queue[0];
-			memcpy(input_queue, input_queue+1, sizeof(struct input_event)*input_queue_sz);
-
-			return &ev;
-		}
+		if (!inputq_empty())
+			break;
 
-		if (!poll(pfds, sizeof pfds / sizeof pfds[0], timeout ? timeout : -1))
-			return NULL;
+		/* Timer expiry is reported as a timeout. */
+		if (!(reactor_wait(REACTOR_DISPLAY | REACTOR_TIMERS, deadline) & REACTOR_DISPLAY))
+			return 0;
 
 		wl_display_dispatch(wl.dpy);
 	}
+
+	return inputq_pop(evs, n);
+}
+
+struct input_event *way_input_next_event(int timeout)
+{
+	static struct input_event ev;
+
+	return way_input_next_events(&ev, 1, timeout) ? &ev : NULL;
 }
 
 void init_input()
@@ -39,6 +39,23 @@ static struct zxdg_output_v1_listener zxdg_output_v1_listener = {
 	.description = noop,
 };
 
+static void wl_output_handle_mode(void *data, struct wl_output *wl_output,
+				  uint32_t flags, int32_t width, int32_t height,
+				  int32_t refresh)
+{
+	struct screen *scr = data;
+
+	if (flags & WL_OUTPUT_MODE_CURRENT)
+		scr->refresh_rate = refresh;
+}
+
+static struct wl_output_listener wl_output_listener = {
+	.geometry = noop,
+	.mode = wl_output_handle_mode,
+	.done = noop,
+	.scale = noop,
+};
+
 static void handle_pointer_enter(void *data,
 				 struct wl_pointer *wl_pointer,
 				 uint32_t serial,
@@ -113,16 +130,17 @@ void add_screen(struct wl_output *output)
 	struct screen *scr = &screens[nr_screens++];
 	scr->overlay = NULL;
 	scr->wl_output = output;
+	scr->refresh_rate = 0;
+
+	wl_output_add_listener(output, &wl_output_listener, scr);
 }
 
-void way_screen_draw_box(struct screen *scr, int x, int y, int w, int h, const char *color)
+void way_screen_draw_box(struct screen *scr, int x, int y, int w, int h, uint32_t color)
 {
-	uint8_t r, g, b, a;
-
 	assert(scr->nr_boxes < MAX_BOXES);
 
-	way_hex_to_rgba(color, &r, &g, &b, &a);
-	cairo_set_source_rgba(scr->cr, r / 255.0, g / 255.0, b / 255.0, a / 255.0);
+	cairo_set_source_rgba(scr->cr, (color >> 24) / 255.0, ((color >> 16) & 0xFF) / 255.0,
+			      ((color >> 8) & 0xFF) / 255.0, (color & 0xFF) / 255.0);
 	cairo_rectangle(scr->cr, x, y, w, h);
 	cairo_fill(scr->cr);
 
@@ -136,6 +154,26 @@ void way_screen_get_dimensions(struct screen *scr, int *w, int *h)
 	*h = scr->h;
 }
 
+int way_screen_get_refresh_rate(struct screen *scr)
+{
+	return scr->refresh_rate;
+}
+
+static void frame_handle_done(void *data, struct wl_callback *cb, uint32_t time)
+{
+	timer_fire((intptr_t)data);
+	wl_callback_destroy(cb);
+}
+
+static const struct wl_callback_listener frame_listener = {
+	.done = frame_handle_done,
+};
+
+int way_timer_arm_vblank(int timer, struct screen *scr)
+{
+	return surface_request_frame(scr->frame, &frame_listener, (void *)(intptr_t)timer);
+}
+
 void way_screen_clear(struct screen *scr)
 {
 	size_t i;
@@ -207,4 +245,7 @@ void init_screen()
 	}
 
 	discover_pointer_location();
+
+	for (i = 0; i < nr_screens; i++)
+		screens[i].frame = create_frame_surface(&screens[i]);
 }
@@ -65,24 +65,12 @@ void destroy_surface(struct surface *sfc)
  * of displaying content on the screen (there is no show/hide) and should be considered a cheap operation
  * which operates on a persistent shared buffer (memory pool). */
 
-struct surface *create_surface(struct screen *scr, int x, int y, int w, int h, int capture_input)
+static struct surface *create_layer_surface(struct screen *scr, size_t offset,
+					    int x, int y, int w, int h)
 {
 	struct surface *sfc = calloc(1, sizeof (struct surface));
 
-	if (x < 0) {
-		x = 0;
-		w += x;
-	}
-	if (y < 0) {
-		y = 0;
-		h += y;
-	}
-	if ((x+w) > scr->w)
-		x = scr->w-w;
-	if ((y+h) > scr->h)
-		y = scr->h-h;
-
-	sfc->wl_buffer = wl_shm_pool_create_buffer(scr->wl_pool, y*scr->stride + x*4, w, h, scr->stride, WL_SHM_FORMAT_ARGB8888);
+	sfc->wl_buffer = wl_shm_pool_create_buffer(scr->wl_pool, offset, w, h, scr->stride, WL_SHM_FORMAT_ARGB8888);
 	assert(sfc->wl_buffer);
 	sfc->wl_surface = wl_compositor_create_surface(wl.compositor);
 
@@ -104,6 +92,28 @@ struct surface *create_surface(struct screen *scr, int x, int y, int w, int h, i
 
 	sfc->configured = 0;
 
+	return sfc;
+}
+
+struct surface *create_surface(struct screen *scr, int x, int y, int w, int h, int capture_input)
+{
+	struct surface *sfc;
+
+	if (x < 0) {
+		x = 0;
+		w += x;
+	}
+	if (y < 0) {
+		y = 0;
+		h += y;
+	}
+	if ((x+w) > scr->w)
+		x = scr->w-w;
+	if ((y+h) > scr->h)
+		y = scr->h-h;
+
+	sfc = create_layer_surface(scr, y*scr->stride + x*4, x, y, w, h);
+
 	if (capture_input) {
 		zwlr_layer_surface_v1_set_keyboard_interactivity(sfc->wl_layer_surface,
 								  ZWLR_LAYER_SURFACE_V1_KEYBOARD_INTERACTIVITY_EXCLUSIVE);
@@ -114,7 +124,64 @@ struct surface *create_surface(struct screen *scr, int x, int y, int w, int h, i
 	return sfc;
 }
 
+/*
+ * A permanently visible, transparent 1x1 surface backed by the spare row at
+ * the end of the pool (which is never drawn to). Its frame callbacks are
+ * used to track the screen's vblank (see surface_request_frame()).
+ */
+struct surface *create_frame_surface(struct screen *scr)
+{
+	struct surface *sfc = create_layer_surface(scr, scr->h*scr->stride, 0, 0, 1, 1);
+	struct wl_region *region = wl_compositor_create_region(wl.compositor);
+
+	/* Let pointer events pass through. */
+	wl_surface_set_input_region(sfc->wl_surface, region);
+	wl_region_destroy(region);
+
+	wl_surface_commit(sfc->wl_surface);
+
+	return sfc;
+}
+
+/*
+ * Asks the compositor to call the listener's done handler once it is a good
+ * time to draw the next frame, i.e at the vblank following the commit.
+ * Returns 0 if the surface hasn't been configured yet.
+ */
+int surface_request_frame(struct surface *sfc, const struct wl_callback_listener *listener, void *data)
+{
+	if (!sfc->configured)
+		return 0;
+
+	wl_callback_add_listener(wl_surface_frame(sfc->wl_surface), listener, data);
+	wl_surface_damage(sfc->wl_surface, 0, 0, 1, 1);
+	surface_commit(sfc);
+
+	return 1;
+}
+
 struct wl_surface *surface_get_wl_surface(struct surface *sfc)
 {
 	return sfc->wl_surface;
 }
+
+/*
+ * Mark a (surface local) region of the shared buffer as modified. Takes
+ * effect on the next surface_commit(). Surfaces which haven't been
+ * configured yet will pick up the current contents when they are.
+ */
+void surface_damage(struct surface *sfc, int x, int y, int w, int h)
+{
+	if (sfc->configured)
+		wl_surface_damage(sfc->wl_surface, x, y, w, h);
+}
+
+/* Republish the buffer after its contents have been modified in place. */
+void surface_commit(struct surface *sfc)
+{
+	if (!sfc->configured)
+		return;
+
+	wl_surface_attach(sfc->wl_surface, sfc->wl_buffer, 0, 0);
+	wl_surface_commit(sfc->wl_surface);
+}
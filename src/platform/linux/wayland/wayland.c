@@ -13,59 +13,19 @@
 
 static uint8_t btn_state[3] = {0};
 
-static struct {
-	const char *name;
-	const char *xname;
-} normalization_map[] = {
-	{"esc", "Escape"},
-	{",", "comma"},
-	{".", "period"},
-	{"-", "minus"},
-	{"/", "slash"},
-	{";", "semicolon"},
-	{"$", "dollar"},
-	{"backspace", "BackSpace"},
-};
-
 struct ptr ptr = {0};
 
 /* Input */
 
+/* The tables are built in handle_keymap(). */
 uint8_t way_input_lookup_code(const char *name, int *shifted)
 {
-	size_t i;
-
-	for (i = 0; i < sizeof normalization_map / sizeof normalization_map[0]; i++)
-		if (!strcmp(normalization_map[i].name, name))
-			name = normalization_map[i].xname;
-
-	for (i = 0; i < 256; i++)
-		if (!strcmp(keymap[i].name, name)) {
-			*shifted = 0;
-			return i;
-		} else if (!strcmp(keymap[i].shifted_name, name)) {
-			*shifted = 1;
-			return i;
-		}
-
-	return 0;
+	return keytable_lookup_code(name, shifted);
 }
 
 const char *way_input_lookup_name(uint8_t code, int shifted)
 {
-	size_t i;
-	const char *name = NULL;
-
-	if (shifted && keymap[code].shifted_name[0])
-		name = keymap[code].shifted_name;
-	else if (!shifted && keymap[code].name[0])
-		name = keymap[code].name;
-	
-	for (i = 0; i < sizeof normalization_map / sizeof normalization_map[0]; i++)
-		if (name && !strcmp(normalization_map[i].xname, name))
-			name = normalization_map[i].name;
-
-	return name;
+	return keytable_lookup_name(code, shifted);
 }
 
 void way_mouse_move(struct screen *scr, int x, int y)
@@ -216,11 +176,13 @@ void wayland_init(struct platform *platform)
 	platform->commit = way_commit;
 	platform->copy_selection = way_copy_selection;
 	platform->hint_draw = way_hint_draw;
+	platform->hint_update = way_hint_update;
 	platform->init_hint = way_init_hint;
 	platform->input_grab_keyboard = way_input_grab_keyboard;
 	platform->input_lookup_code = way_input_lookup_code;
 	platform->input_lookup_name = way_input_lookup_name;
 	platform->input_next_event = way_input_next_event;
+	platform->input_next_events = way_input_next_events;
 	platform->input_ungrab_keyboard = way_input_ungrab_keyboard;
 	platform->input_wait = way_input_wait;
 	platform->mouse_click = way_mouse_click;
@@ -234,5 +196,8 @@ void wayland_init(struct platform *platform)
 	platform->screen_draw_box = way_screen_draw_box;
 	platform->screen_get_dimensions = way_screen_get_dimensions;
 	platform->screen_list = way_screen_list;
+	platform->screen_get_refresh_rate = way_screen_get_refresh_rate;
 	platform->scroll = way_scroll;
+	platform->timer_arm = reactor_timer_set;
+	platform->timer_arm_vblank = way_timer_arm_vblank;
 }
@@ -8,7 +8,6 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <poll.h>
 #include <assert.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -22,6 +21,9 @@
 #include <xkbcommon/xkbcommon.h>
 
 #include "../../../platform.h"
+#include "../inputq.h"
+#include "../keytable.h"
+#include "../reactor.h"
 #include "wl/xdg-shell.h"
 #include "wl/virtual-pointer.h"
 #include "wl/layer-shell.h"
@@ -50,6 +52,9 @@ struct screen {
 	int ptrx;
 	int ptry;
 
+	/* mHz, 0 if unknown */
+	int refresh_rate;
+
 	int state;
 
 	size_t nr_boxes;
@@ -58,6 +63,9 @@ struct screen {
 	struct surface *overlay;
 	struct surface *hints;
 
+	/* Used to track vblank. */
+	struct surface *frame;
+
 	struct wl_output *wl_output;
 	struct zxdg_output_v1 *xdg_output;
 
@@ -68,16 +76,10 @@ struct screen {
 
 struct surface;
 
-struct keymap_entry {
-	char name[32];
-	char shifted_name[32];
-};
-
 extern struct screen screens[MAX_SCREENS];
 extern size_t nr_screens;
 
 void add_screen(struct wl_output *output);
-int way_hex_to_rgba(const char *str, uint8_t *r, uint8_t *g, uint8_t *b, uint8_t *a);
 
 void init_screen();
 
@@ -88,7 +90,6 @@ struct ptr {
 };
 
 /* Globals */
-extern struct keymap_entry keymap[256];
 extern char keynames[256][32];
 extern struct ptr ptr;
 extern struct wl wl;
@@ -96,8 +97,12 @@ extern struct wl wl;
 
 /* Surface manipulation */
 struct surface *create_surface(struct screen *scr, int x, int y, int w, int h, int capture_input);
+struct surface *create_frame_surface(struct screen *scr);
+int surface_request_frame(struct surface *sfc, const struct wl_callback_listener *listener, void *data);
 void destroy_surface(struct surface *sfc);
 struct wl_surface *surface_get_wl_surface(struct surface *sfc);
+void surface_damage(struct surface *sfc, int x, int y, int w, int h);
+void surface_commit(struct surface *sfc);
 void surface_show(struct surface *sfc);
 
 /* Exported platform functions. */
@@ -105,6 +110,7 @@ void way_run(void (*init)(void));
 void way_input_grab_keyboard();
 void way_input_ungrab_keyboard();
 struct input_event *way_input_next_event(int timeout);
+size_t way_input_next_events(struct input_event *evs, size_t n, int timeout);
 uint8_t way_input_lookup_code(const char *name, int *shifted);
 const char *way_input_lookup_name(uint8_t code, int shifted);
 struct input_event *way_input_wait(struct input_event *events, size_t sz);
@@ -116,11 +122,14 @@ void way_mouse_get_position(screen_t *scr, int *x, int *y);
 void way_mouse_show();
 void way_mouse_hide();
 void way_screen_get_dimensions(screen_t scr, int *w, int *h);
-void way_screen_draw_box(screen_t scr, int x, int y, int w, int h, const char *color);
+int way_screen_get_refresh_rate(screen_t scr);
+int way_timer_arm_vblank(int timer, screen_t scr);
+void way_screen_draw_box(screen_t scr, int x, int y, int w, int h, uint32_t color);
 void way_screen_clear(screen_t scr);
 void way_screen_list(screen_t scr[MAX_SCREENS], size_t *n);
-void way_init_hint(const char *bg, const char *fg, int border_radius, const char *font_family);
+void way_init_hint(uint32_t bg, uint32_t fg, int border_radius, const char *font_family);
 void way_hint_draw(struct screen *scr, struct hint *hints, size_t n);
+void way_hint_update(struct screen *scr, struct hint *removed, size_t n);
 void way_scroll(int direction);
 void way_copy_selection();
 void way_commit();
@@ -57,6 +57,8 @@ void way_init()
 		exit(-1);
 	}
 
+	reactor_add_fd(wl_display_get_fd(wl.dpy), REACTOR_DISPLAY);
+
 	wl_registry_add_listener(wl_display_get_registry(wl.dpy), &registry_listener, NULL);
 
 	wl_display_dispatch(wl.dpy);
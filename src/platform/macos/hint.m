@@ -4,7 +4,7 @@ static float border_radius;
 
 static NSColor *bgColor;
 static NSColor *fgColor;
-const char *font;
+static char font[256];
 
 
 static void draw_hook(void *arg, NSView *view)
@@ -30,13 +30,13 @@ void osx_hint_draw(struct screen *scr, struct hint *hints, size_t n)
 	window_register_draw_hook(scr->overlay, draw_hook, scr);
 }
 
-void osx_init_hint(const char *bg, const char *fg, int _border_radius,
+void osx_init_hint(uint32_t bg, uint32_t fg, int _border_radius,
 	       const char *font_family)
 {
-	bgColor = nscolor_from_hex(bg);
-	fgColor = nscolor_from_hex(fg);
+	bgColor = nscolor_from_rgba(bg);
+	fgColor = nscolor_from_rgba(fg);
 
 	border_radius = (float)_border_radius;
-	font = font_family;
+	snprintf(font, sizeof font, "%s", font_family);
 }
 
@@ -60,6 +60,9 @@ struct screen {
 	int w;
 	int h;
 
+	/* mHz, 0 if unknown */
+	int refresh_rate;
+
 	struct hint hints[MAX_HINTS];
 	size_t nr_hints;
 
@@ -79,7 +82,7 @@ void window_register_draw_hook(struct window *win,
 			       void (*draw)(void *arg, NSView *view),
 			       void *arg);
 
-struct window *create_window(const char *color, size_t w, size_t h);
+struct window *create_window(uint32_t color, size_t w, size_t h);
 struct window *create_overlay_window();
 
 void macos_init_input();
@@ -94,7 +97,7 @@ void macos_draw_text(struct screen *scr, NSColor *col, const char *font, int x,
 
 void send_key(uint8_t code, int pressed);
 
-NSColor *nscolor_from_hex(const char *str);
+NSColor *nscolor_from_rgba(uint32_t color);
 
 extern struct screen screens[32];
 extern size_t nr_screens;
@@ -114,10 +117,11 @@ void osx_mouse_get_position(screen_t *scr, int *x, int *y);
 void osx_mouse_show();
 void osx_mouse_hide();
 void osx_screen_get_dimensions(screen_t scr, int *w, int *h);
-void osx_screen_draw_box(screen_t scr, int x, int y, int w, int h, const char *color);
+int osx_screen_get_refresh_rate(screen_t scr);
+void osx_screen_draw_box(screen_t scr, int x, int y, int w, int h, uint32_t color);
 void osx_screen_clear(screen_t scr);
 void osx_screen_list(screen_t scr[MAX_SCREENS], size_t *n);
-void osx_init_hint(const char *bg, const char *fg, int border_radius, const char *font_family);
+void osx_init_hint(uint32_t bg, uint32_t fg, int border_radius, const char *font_family);
 void osx_hint_draw(struct screen *scr, struct hint *hints, size_t n);
 void osx_scroll(int direction);
 void osx_copy_selection();
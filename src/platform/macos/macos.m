@@ -67,46 +67,12 @@ void macos_draw_box(struct screen *scr, NSColor *col, float x, float y, float w,
 }
 
 
-NSColor *nscolor_from_hex(const char *str)
+NSColor *nscolor_from_rgba(uint32_t color)
 {
-	ssize_t len;
-	uint8_t r, g, b, a;
-#define X2B(c) ((c >= '0' && c <= '9') ? (c & 0xF) : (((c | 0x20) - 'a') + 10))
-
-	if (str == NULL)
-		return 0;
-
-	str = (*str == '#') ? str + 1 : str;
-	len = strlen(str);
-
-	if (len != 6 && len != 8) {
-		fprintf(stderr, "Failed to parse %s, paint it black!\n", str);
-		return NSColor.blackColor;
-	}
-
-	r = X2B(str[0]);
-	r <<= 4;
-	r |= X2B(str[1]);
-
-	g = X2B(str[2]);
-	g <<= 4;
-	g |= X2B(str[3]);
-
-	b = X2B(str[4]);
-	b <<= 4;
-	b |= X2B(str[5]);
-
-	a = 255;
-	if (len == 8) {
-		a = X2B(str[6]);
-		a <<= 4;
-		a |= X2B(str[7]);
-	}
-
-	return [NSColor colorWithCalibratedRed:(float)r / 255
-					 green:(float)g / 255
-					  blue:(float)b / 255
-					 alpha:(float)a / 255];
+	return [NSColor colorWithCalibratedRed:(float)(color >> 24) / 255
+					 green:(float)((color >> 16) & 0xFF) / 255
+					  blue:(float)((color >> 8) & 0xFF) / 255
+					 alpha:(float)(color & 0xFF) / 255];
 }
 
 void osx_copy_selection()
@@ -183,13 +149,13 @@ static void *mainloop(void *arg)
 		.screen_clear = osx_screen_clear,
 		.screen_draw_box = osx_screen_draw_box,
 		.screen_get_dimensions = osx_screen_get_dimensions,
+		.screen_get_refresh_rate = osx_screen_get_refresh_rate,
 		.screen_list = osx_screen_list,
 		.scroll = osx_scroll,
 		.monitor_file = osx_monitor_file,
 	};
 
-	main(&platform);
-	exit(0);
+	exit(main(&platform));
 }
 
 
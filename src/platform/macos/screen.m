@@ -15,7 +15,7 @@ static void draw_hook(void *arg, NSView *view)
 	macos_draw_box(b->scr, b->color, b->x, b->y, b->w, b->h, 0);
 }
 
-void osx_screen_draw_box(struct screen *scr, int x, int y, int w, int h, const char *color)
+void osx_screen_draw_box(struct screen *scr, int x, int y, int w, int h, uint32_t color)
 {
 	assert(scr->nr_boxes < MAX_BOXES);
 	struct box *b = &scr->boxes[scr->nr_boxes++];
@@ -25,7 +25,7 @@ void osx_screen_draw_box(struct screen *scr, int x, int y, int w, int h, const c
 	b->w = w;
 	b->h = h;
 	b->scr = scr;
-	b->color = nscolor_from_hex(color);
+	b->color = nscolor_from_rgba(color);
 
 	window_register_draw_hook(scr->overlay, draw_hook, b);
 }
@@ -52,6 +52,27 @@ void osx_screen_get_dimensions(struct screen *scr, int *w, int *h)
 	*h = scr->h;
 }
 
+int osx_screen_get_refresh_rate(struct screen *scr)
+{
+	return scr->refresh_rate;
+}
+
+static int display_refresh_rate(NSScreen *screen)
+{
+	int rate;
+	CGDisplayModeRef mode;
+	CGDirectDisplayID id = [[screen.deviceDescription
+				 objectForKey:@"NSScreenNumber"] unsignedIntValue];
+
+	if (!(mode = CGDisplayCopyDisplayMode(id)))
+		return 0;
+
+	rate = CGDisplayModeGetRefreshRate(mode) * 1000;
+	CGDisplayModeRelease(mode);
+
+	return rate;
+}
+
 void macos_init_screen()
 {
 	for (NSScreen *screen in NSScreen.screens) {
@@ -61,6 +82,7 @@ void macos_init_screen()
 		scr->y = screen.frame.origin.y;
 		scr->w = screen.frame.size.width;
 		scr->h = screen.frame.size.height;
+		scr->refresh_rate = display_refresh_rate(screen);
 
 		scr->overlay = create_overlay_window(scr->x, scr->y, scr->w, scr->h);
 	}
@@ -89,7 +89,7 @@ struct window *create_overlay_window(int x, int y, int w, int h)
 	return win;
 }
 
-struct window *create_window(const char *color, size_t w, size_t h)
+struct window *create_window(uint32_t color, size_t w, size_t h)
 {
 	struct window *win = calloc(1, sizeof(struct window));
 	NSRect rect = NSMakeRect(0, 0, (float)w, (float)h);
@@ -100,7 +100,7 @@ struct window *create_window(const char *color, size_t w, size_t h)
 			backing:NSBackingStoreBuffered
 			  defer:FALSE];
 
-	[nsWin setBackgroundColor:nscolor_from_hex(color)];
+	[nsWin setBackgroundColor:nscolor_from_rgba(color)];
 	[nsWin setLevel:NSMainMenuWindowLevel + 9000];
 	[nsWin makeKeyAndOrderFront:nil];
 
@@ -62,25 +62,9 @@ passthrough:
 	return CallNextHookEx(NULL, nCode, wParam, lParam);
 }
 
-static COLORREF str_to_colorref(const char *s)
+static COLORREF rgba_to_colorref(uint32_t color)
 {
-
-    #define HEXVAL(c) ((c >= '0' && c <= '9') ? (c-'0') :\
-            (c >= 'a' && c <= 'f') ?  (c - 'a' + 10) :\
-            (c-'A'+10))
-
-    if (s[0] == '#')
-        s++;
-
-    if (strlen(s) == 6)
-        return HEXVAL(s[5]) << 16 |
-            HEXVAL(s[4]) << 20 |
-            HEXVAL(s[3]) << 8 |
-            HEXVAL(s[2]) << 12 |
-            HEXVAL(s[1]) << 0 |
-            HEXVAL(s[0]) << 4;
-
-    return 0;
+	return RGB(color >> 24, (color >> 16) & 0xFF, (color >> 8) & 0xFF);
 }
 
 static void utf8_encode(const wchar_t *wstr, char *buf, size_t buf_sz)
@@ -96,9 +80,9 @@ static void screen_clear(screen_t scr)
 	wn_screen_clear(scr);
 }
 
-static void screen_draw_box(screen_t scr, int x, int y, int w, int h, const char *color)
+static void screen_draw_box(screen_t scr, int x, int y, int w, int h, uint32_t color)
 {
-	wn_screen_add_box(scr, x, y, w, h, str_to_colorref(color));
+	wn_screen_add_box(scr, x, y, w, h, rgba_to_colorref(color));
 }
 
 static struct input_event *input_next_event(int timeout)
@@ -134,10 +118,10 @@ static struct input_event *input_next_event(int timeout)
 	}
 }
 
-static void init_hint(const char *bg, const char *fg, int border_radius, const char *font_family)
+static void init_hint(uint32_t bg, uint32_t fg, int border_radius, const char *font_family)
 {
 	//TODO: handle font family and border radius.
-	wn_screen_set_hintinfo(str_to_colorref(bg), str_to_colorref(fg));
+	wn_screen_set_hintinfo(rgba_to_colorref(bg), rgba_to_colorref(fg));
 }
 
 //====================================================================================
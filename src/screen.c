@@ -6,7 +6,7 @@ void screen_selection_mode()
 	size_t n;
 	screen_t screens[MAX_SCREENS];
 	struct input_event *ev;
-	const char *screen_chars = config_get("screen_chars");
+	const char *screen_chars = config_get(CFG_SCREEN_CHARS);
 
 	platform->screen_list(screens, &n);
 	assert(strlen(screen_chars) >= n);
@@ -29,13 +29,11 @@ void screen_selection_mode()
 
 	platform->commit();
 
-	platform->input_grab_keyboard();
 	while (1) {
-		ev = platform->input_next_event(0);
+		ev = input_next_event(0);
 		if (ev->pressed)
 			break;
 	}
-	platform->input_ungrab_keyboard();
 
 	for (i = 0; i < n; i++) {
 		const char *key = input_event_tostr(ev);
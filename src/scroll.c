@@ -15,10 +15,10 @@
 #define fling_velocity (2000.0 / factor);
 
 /* terminal velocity */
-#define vt ((float)config_get_int("scroll_max_speed") / factor)
-#define v0 ((float)config_get_int("scroll_speed") / factor)
-#define da0 ((float)config_get_int("scroll_deceleration") / factor) /* deceleration */
-#define a0 ((float)config_get_int("scroll_acceleration") / factor)
+#define vt ((float)config_get_int(CFG_SCROLL_MAX_SPEED) / factor)
+#define v0 ((float)config_get_int(CFG_SCROLL_SPEED) / factor)
+#define da0 ((float)config_get_int(CFG_SCROLL_DECELERATION) / factor) /* deceleration */
+#define a0 ((float)config_get_int(CFG_SCROLL_ACCELERATION) / factor)
 
 static long last_tick = 0;
 
@@ -82,9 +82,18 @@ void scroll_accelerate(int _direction)
 		d = 0;
 		traveled = 0;
 		v = v0;
+
+		/* We may not have been ticked for a while. */
+		last_tick = get_time_us()/1000;
 	}
 }
 
+/* Returns 1 while scrolling (including decelerating after release). */
+int scroll_active()
+{
+	return v > 0;
+}
+
 void scroll_impart_impulse()
 {
 	v += fling_velocity;
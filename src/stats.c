@@ -0,0 +1,295 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * Input latency instrumentation (--stats).
+ *
+ * Key presses are stamped as they are returned by the platform and the
+ * time until the first resulting output operation (pointer motion, click,
+ * scroll or draw commit) is recorded in a per mode histogram. The time from
+ * a key press which switches modes to the first output of the next mode is
+ * recorded separately (as "transition"). Histograms are printed to stderr
+ * on exit and on receipt of SIGUSR1 (by the main loop, once the next input
+ * event or timeout is returned, see handle_sigusr1()).
+ *
+ * Buckets are log-linear (HDR style): values below 32us are exact, above
+ * that each power of two is divided into 16 buckets (~6% resolution).
+ */
+
+#include "warpd.h"
+
+#include <signal.h>
+
+#define SUB_BUCKETS 16
+#define NR_BUCKETS (SUB_BUCKETS * 30)
+
+struct histogram {
+	uint64_t counts[NR_BUCKETS];
+	uint64_t n;
+	uint64_t sum;
+	uint64_t max;
+};
+
+static const char *mode_names[] = {
+	[MODE_HISTORY] = "history",
+	[MODE_HINT] = "hint",
+	[MODE_HINT2] = "hint2",
+	[MODE_GRID] = "grid",
+	[MODE_NORMAL] = "normal",
+	[MODE_HINTSPEC] = "hintspec",
+	[MODE_SCREEN_SELECTION] = "screen",
+};
+
+#define NR_MODES (sizeof mode_names / sizeof mode_names[0])
+
+static struct histogram histograms[NR_MODES];
+static struct histogram transitions;
+
+static int enabled;
+static volatile sig_atomic_t dump_requested;
+static int current_mode = MODE_NORMAL;
+
+/* Arrival time of the last key press which hasn't produced output yet. */
+static uint64_t pending;
+
+static uint64_t last_press;
+
+/* Arrival time of the key press which caused the current mode transition. */
+static uint64_t transition_start;
+
+static struct input_event *(*real_input_next_event)(int timeout);
+static size_t (*real_input_next_events)(struct input_event *evs, size_t n, int timeout);
+static struct input_event *(*real_input_wait)(struct input_event *events, size_t sz);
+static void (*real_mouse_move)(screen_t scr, int x, int y);
+static void (*real_mouse_click)(int btn);
+static void (*real_scroll)(int direction);
+static void (*real_commit)();
+
+static size_t bucket_index(uint64_t v)
+{
+	size_t e = 0;
+
+	if (v < 2 * SUB_BUCKETS)
+		return v;
+
+	while (v >> (e + 1))
+		e++;
+
+	/* e >= 5 */
+	v = (v >> (e - 4)) & (SUB_BUCKETS - 1);
+	e = (e - 3) * SUB_BUCKETS + v;
+
+	return e < NR_BUCKETS ? e : NR_BUCKETS - 1;
+}
+
+/* Returns the upper bound of the given bucket. */
+static uint64_t bucket_value(size_t idx)
+{
+	size_t e;
+
+	if (idx < 2 * SUB_BUCKETS)
+		return idx;
+
+	e = idx / SUB_BUCKETS + 3;
+	return (((uint64_t)(SUB_BUCKETS + idx % SUB_BUCKETS + 1)) << (e - 4)) - 1;
+}
+
+static uint64_t percentile(struct histogram *h, double p)
+{
+	size_t i;
+	uint64_t n = 0;
+	uint64_t target = (uint64_t)(h->n * p + 0.5);
+
+	if (!target)
+		target = 1;
+
+	for (i = 0; i < NR_BUCKETS; i++) {
+		n += h->counts[i];
+		if (n >= target)
+			return MIN(bucket_value(i), h->max);
+	}
+
+	return h->max;
+}
+
+static void record(struct histogram *h, uint64_t t)
+{
+	h->counts[bucket_index(t)]++;
+	h->n++;
+	h->sum += t;
+	if (t > h->max)
+		h->max = t;
+}
+
+static void record_output()
+{
+	const uint64_t t = get_real_time_us();
+
+	if (transition_start) {
+		record(&transitions, t - transition_start);
+		transition_start = 0;
+	}
+
+	if (!pending)
+		return;
+
+	record(&histograms[current_mode], t - pending);
+	pending = 0;
+}
+
+static void check_dump()
+{
+	if (dump_requested) {
+		dump_requested = 0;
+		stats_dump();
+	}
+}
+
+static struct input_event *stats_input_next_event(int timeout)
+{
+	struct input_event *ev = real_input_next_event(timeout);
+
+	if (ev && ev->pressed)
+		pending = last_press = get_real_time_us();
+
+	check_dump();
+	return ev;
+}
+
+static size_t stats_input_next_events(struct input_event *evs, size_t n, int timeout)
+{
+	size_t i;
+	size_t nr = real_input_next_events(evs, n, timeout);
+
+	for (i = 0; i < nr; i++)
+		if (evs[i].pressed)
+			pending = last_press = get_real_time_us();
+
+	check_dump();
+	return nr;
+}
+
+static struct input_event *stats_input_wait(struct input_event *events, size_t sz)
+{
+	struct input_event *ev = real_input_wait(events, sz);
+
+	if (ev)
+		pending = get_real_time_us();
+
+	check_dump();
+	return ev;
+}
+
+static void stats_mouse_move(screen_t scr, int x, int y)
+{
+	record_output();
+	real_mouse_move(scr, x, y);
+}
+
+static void stats_mouse_click(int btn)
+{
+	record_output();
+	real_mouse_click(btn);
+}
+
+static void stats_scroll(int direction)
+{
+	record_output();
+	real_scroll(direction);
+}
+
+static void stats_commit()
+{
+	record_output();
+	real_commit();
+}
+
+static void print_histogram(const char *name, struct histogram *h)
+{
+	if (!h->n)
+		return;
+
+	fprintf(stderr, "%-10s %8lu %8lu %8lu %8lu %8lu %8lu %8lu\n",
+		name,
+		(unsigned long)h->n,
+		(unsigned long)(h->sum / h->n),
+		(unsigned long)percentile(h, .5),
+		(unsigned long)percentile(h, .9),
+		(unsigned long)percentile(h, .99),
+		(unsigned long)percentile(h, .999),
+		(unsigned long)h->max);
+}
+
+void stats_dump()
+{
+	size_t i;
+
+	fprintf(stderr, "%-10s %8s %8s %8s %8s %8s %8s %8s (us)\n",
+		"mode", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+
+	for (i = 0; i < NR_MODES; i++)
+		print_histogram(mode_names[i], &histograms[i]);
+
+	print_histogram("transition", &transitions);
+}
+
+#ifdef SIGUSR1
+/*
+ * Neither stdio nor the histograms (which may be mid update) can be touched
+ * from a signal handler, so the dump is left to the main loop.
+ */
+static void handle_sigusr1(int sig)
+{
+	dump_requested = 1;
+}
+#endif
+
+void stats_set_mode(int mode)
+{
+	if (mode > 0 && (size_t)mode < NR_MODES)
+		current_mode = mode;
+}
+
+/*
+ * Called between modes within a session, the next output is attributed to
+ * the transition from the key press which ended the last mode.
+ */
+void stats_transition()
+{
+	if (enabled)
+		transition_start = last_press;
+}
+
+/* Must be called after the platform has been initialized. */
+void stats_init()
+{
+	if (enabled)
+		return;
+
+	enabled = 1;
+
+	real_input_next_event = platform->input_next_event;
+	real_input_next_events = platform->input_next_events;
+	real_input_wait = platform->input_wait;
+	real_mouse_move = platform->mouse_move;
+	real_mouse_click = platform->mouse_click;
+	real_scroll = platform->scroll;
+	real_commit = platform->commit;
+
+	platform->input_next_event = stats_input_next_event;
+	if (real_input_next_events)
+		platform->input_next_events = stats_input_next_events;
+	platform->input_wait = stats_input_wait;
+	platform->mouse_move = stats_mouse_move;
+	platform->mouse_click = stats_mouse_click;
+	platform->scroll = stats_scroll;
+	platform->commit = stats_commit;
+
+#ifdef SIGUSR1
+	signal(SIGUSR1, handle_sigusr1);
+#endif
+	atexit(stats_dump);
+}
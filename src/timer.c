@@ -0,0 +1,134 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * Named timers with absolute deadlines (in get_time_us() time).
+ *
+ * Modes arm the timers they need and read input with timer_next_event(),
+ * which waits until the next input event or the earliest deadline.
+ * Expiry is checked against the clock rather than inferred from the wait
+ * having timed out, so deadlines don't drift when a wait is cut short by
+ * input.
+ *
+ * Where the platform supports it (timer_arm), the deadlines are also
+ * registered with its event loop, so waiting doesn't involve computing a
+ * timeout at all. This only works on the real clock, so a replaced clock
+ * (trace replay, headless) falls back to passing the earliest deadline as
+ * the input timeout.
+ *
+ * TIMER_FRAME can also follow the vblank of a screen (timer_arm_vblank),
+ * in which case the platform expires it with timer_fire().
+ */
+
+#include "warpd.h"
+
+static uint64_t deadlines[NR_TIMERS];
+
+static int platform_timers()
+{
+	return platform->timer_arm && clock_is_real();
+}
+
+void timer_set(enum timer timer, uint64_t deadline)
+{
+	deadlines[timer] = deadline;
+
+	if (platform_timers())
+		platform->timer_arm(timer, deadline);
+}
+
+/*
+ * Called by the platform once a vblank requested with timer_arm_vblank has
+ * happened. Late notifications for timers which have since been cleared
+ * are ignored.
+ */
+void timer_fire(int timer)
+{
+	if (timer >= 0 && timer < NR_TIMERS && deadlines[timer])
+		timer_set(timer, get_time_us());
+}
+
+void timer_clear(enum timer timer)
+{
+	timer_set(timer, 0);
+}
+
+int timer_armed(enum timer timer)
+{
+	return deadlines[timer] != 0;
+}
+
+int timer_expired(enum timer timer)
+{
+	return deadlines[timer] && deadlines[timer] <= get_time_us();
+}
+
+/*
+ * Re-arms a periodic timer (interval in us) relative to its last deadline,
+ * skipping any periods which have been missed entirely.
+ */
+void timer_advance(enum timer timer, uint64_t interval)
+{
+	const uint64_t t = get_time_us();
+	uint64_t deadline = deadlines[timer] + interval;
+
+	if (deadline <= t)
+		deadline = t + interval;
+
+	timer_set(timer, deadline);
+}
+
+/*
+ * Arms TIMER_FRAME for the next frame of the given screen: its next vblank
+ * where the platform reports it, one refresh period after the last frame
+ * otherwise.
+ */
+void timer_next_frame(screen_t scr)
+{
+	const uint64_t interval = frame_interval(scr);
+
+	if (platform_timers() && platform->timer_arm_vblank &&
+	    platform->timer_arm_vblank(TIMER_FRAME, scr)) {
+		/* In case the vblank is never reported (e.g the screen is off). */
+		timer_set(TIMER_FRAME, get_time_us() + interval * 3 / 2);
+		return;
+	}
+
+	if (timer_armed(TIMER_FRAME))
+		timer_advance(TIMER_FRAME, interval);
+	else
+		timer_set(TIMER_FRAME, get_time_us() + interval);
+}
+
+/*
+ * Returns the next input event, or NULL once the earliest armed timer has
+ * expired. Blocks indefinitely if no timers are armed.
+ */
+struct input_event *timer_next_event()
+{
+	size_t i;
+	int timeout = 0;
+	uint64_t next = 0;
+
+	if (platform_timers())
+		return input_next_event(0);
+
+	for (i = 0; i < NR_TIMERS; i++)
+		if (deadlines[i] && (!next || deadlines[i] < next))
+			next = deadlines[i];
+
+	if (next) {
+		const uint64_t t = get_time_us();
+
+		/*
+		 * Round up so we never wake before the deadline. An overdue
+		 * timer still polls for input (0 would block).
+		 */
+		timeout = next > t ? (next - t + 999) / 1000 : 1;
+	}
+
+	return input_next_event(timeout);
+}
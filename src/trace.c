@@ -0,0 +1,230 @@
+/*
+ * warpd - A modal keyboard-driven pointing system.
+ *
+ * © 2019 Raheman Vaiya (see: LICENSE).
+ */
+
+/*
+ * Input trace recording (--record-trace) and replay (--replay-trace).
+ *
+ * A trace consists of TRACE_MAGIC followed by a sequence of fixed size
+ * records (host byte order), one for every value returned by
+ * input_next_event (including timeouts) and input_wait (including
+ * interruptions), stamped with the time since the start of the trace.
+ *
+ * Replay substitutes the platform's input functions. By default records
+ * are delivered at their original times. In fast mode they are delivered
+ * immediately and the clock returned by get_time_us() is replaced with the
+ * recorded one, so time dependent logic (e.g pointer acceleration) behaves
+ * exactly as it did during recording.
+ */
+
+#include "warpd.h"
+
+#include <errno.h>
+
+#define TRACE_MAGIC "WARPDTR1"
+
+enum {
+	TRACE_EVENT = 1,
+	TRACE_TIMEOUT,
+	TRACE_WAIT_EVENT,
+	TRACE_WAIT_INTERRUPT,
+};
+
+struct trace_record {
+	uint64_t time;
+	int32_t timeout;
+
+	uint8_t type;
+	uint8_t code;
+	uint8_t mods;
+	uint8_t pressed;
+};
+
+static struct input_event *(*real_input_next_event)(int timeout);
+static struct input_event *(*real_input_wait)(struct input_event *events, size_t sz);
+
+static FILE *record_fh;
+static uint64_t record_start;
+
+static FILE *replay_fh;
+static uint64_t replay_start;
+static uint64_t replay_clock;
+static size_t nr_replayed;
+static int replay_fast;
+
+static void record(int type, int timeout, struct input_event *ev)
+{
+	struct trace_record rec = {0};
+
+	rec.time = get_time_us() - record_start;
+	rec.timeout = timeout;
+	rec.type = type;
+
+	if (ev) {
+		rec.code = ev->code;
+		rec.mods = ev->mods;
+		rec.pressed = ev->pressed;
+	}
+
+	fwrite(&rec, sizeof rec, 1, record_fh);
+}
+
+static struct input_event *record_input_next_event(int timeout)
+{
+	struct input_event *ev = real_input_next_event(timeout);
+
+	record(ev ? TRACE_EVENT : TRACE_TIMEOUT, timeout, ev);
+	return ev;
+}
+
+static struct input_event *record_input_wait(struct input_event *events, size_t sz)
+{
+	struct input_event *ev = real_input_wait(events, sz);
+
+	record(ev ? TRACE_WAIT_EVENT : TRACE_WAIT_INTERRUPT, 0, ev);
+
+	/* The daemon may sit here indefinitely, don't lose the session. */
+	fflush(record_fh);
+
+	return ev;
+}
+
+static uint64_t replay_get_time_us()
+{
+	return replay_clock;
+}
+
+static void sleep_until(uint64_t t)
+{
+	uint64_t now = get_real_time_us();
+
+	if (t > now) {
+		struct timespec ts = {
+			(t - now) / 1000000,
+			((t - now) % 1000000) * 1000,
+		};
+
+		while (nanosleep(&ts, &ts) && errno == EINTR)
+			;
+	}
+}
+
+/* Returns the next record, or exits once the trace is exhausted. */
+static struct trace_record *next_record()
+{
+	static struct trace_record rec;
+
+	if (fread(&rec, sizeof rec, 1, replay_fh) != 1) {
+		fprintf(stderr, "Replayed %zu records in %lu us\n", nr_replayed,
+			(unsigned long)(get_real_time_us() - replay_start));
+		exit(0);
+	}
+
+	if (replay_fast)
+		replay_clock = replay_start + rec.time;
+	else
+		sleep_until(replay_start + rec.time);
+
+	nr_replayed++;
+	return &rec;
+}
+
+static struct input_event *replay_event(struct trace_record *rec)
+{
+	static struct input_event ev;
+
+	ev.code = rec->code;
+	ev.mods = rec->mods;
+	ev.pressed = rec->pressed;
+
+	return &ev;
+}
+
+static struct input_event *replay_input_next_event(int timeout)
+{
+	struct trace_record *rec = next_record();
+
+	switch (rec->type) {
+	case TRACE_EVENT:
+		return replay_event(rec);
+	case TRACE_TIMEOUT:
+		return NULL;
+	default:
+		fprintf(stderr, "ERROR: trace diverged at record %zu (expected an event)\n", nr_replayed);
+		exit(-1);
+	}
+}
+
+static struct input_event *replay_input_wait(struct input_event *events, size_t sz)
+{
+	struct trace_record *rec = next_record();
+
+	switch (rec->type) {
+	case TRACE_WAIT_EVENT:
+		/* input_wait grabs the keyboard on success. */
+		platform->input_grab_keyboard();
+		return replay_event(rec);
+	case TRACE_WAIT_INTERRUPT:
+		return NULL;
+	default:
+		fprintf(stderr, "ERROR: trace diverged at record %zu (expected activation)\n", nr_replayed);
+		exit(-1);
+	}
+}
+
+/*
+ * Must be called after the platform has been initialized and before any
+ * input is read. Either path may be NULL.
+ */
+void trace_init(const char *record_path, const char *replay_path, int fast)
+{
+	char magic[sizeof TRACE_MAGIC - 1];
+
+	real_input_next_event = platform->input_next_event;
+	real_input_wait = platform->input_wait;
+
+	/* Events are recorded and replayed one at a time. */
+	if (replay_path || record_path)
+		platform->input_next_events = NULL;
+
+	if (replay_path) {
+		if (!(replay_fh = fopen(replay_path, "rb"))) {
+			perror(replay_path);
+			exit(-1);
+		}
+
+		if (fread(magic, sizeof magic, 1, replay_fh) != 1 ||
+		    memcmp(magic, TRACE_MAGIC, sizeof magic)) {
+			fprintf(stderr, "ERROR: %s is not a valid trace\n", replay_path);
+			exit(-1);
+		}
+
+		replay_fast = fast;
+		replay_start = get_real_time_us();
+		replay_clock = replay_start;
+
+		if (fast)
+			set_clock_source(replay_get_time_us);
+
+		platform->input_next_event = replay_input_next_event;
+		platform->input_wait = replay_input_wait;
+
+		real_input_next_event = replay_input_next_event;
+		real_input_wait = replay_input_wait;
+	}
+
+	if (record_path) {
+		if (!(record_fh = fopen(record_path, "wb"))) {
+			perror(record_path);
+			exit(-1);
+		}
+
+		fwrite(TRACE_MAGIC, sizeof TRACE_MAGIC - 1, 1, record_fh);
+		record_start = get_time_us();
+
+		platform->input_next_event = record_input_next_event;
+		platform->input_wait = record_input_wait;
+	}
+}
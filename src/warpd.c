@@ -10,7 +10,15 @@ struct platform *platform = NULL;
 
 static const char *config_path;
 
-uint64_t get_time_us()
+static const char *record_trace_path;
+static const char *replay_trace_path;
+static int replay_fast;
+static int stats_flag;
+static int batch_flag;
+
+static uint64_t (*clock_source)();
+
+uint64_t get_real_time_us()
 {
 	struct timespec ts;
 	clock_gettime(CLOCK_MONOTONIC, &ts);
@@ -18,6 +26,23 @@ uint64_t get_time_us()
 	return ts.tv_nsec / 1E3 + ts.tv_sec * 1E6;
 }
 
+/* Replaces the clock used by get_time_us() (e.g during trace replay). */
+void set_clock_source(uint64_t (*fn)())
+{
+	clock_source = fn;
+}
+
+/* Returns 1 if get_time_us() hasn't been replaced by set_clock_source(). */
+int clock_is_real()
+{
+	return !clock_source;
+}
+
+uint64_t get_time_us()
+{
+	return clock_source ? clock_source() : get_real_time_us();
+}
+
 
 const char *get_data_path(const char *file)
 {
@@ -123,7 +148,12 @@ static void print_usage()
 		"  --move '<x> <y>'            Move the pointer to the specified coordinates.\n"
 		"  --click <button>            Send a mouse click corresponding to the supplied button and exit. May be paired with --move.\n"
 		"  -q, --query                 Consumes a list of hints from stdin and presents a one off hint selection.\n"
-		"  --record                    When used with --click, records the event in warpd's hint history.\n\n"
+		"  --record                    When used with --click, records the event in warpd's hint history.\n"
+		"  --record-trace <file>       Record all input to the given file (see --replay-trace).\n"
+		"  --replay-trace <file>       Replay input from a trace created with --record-trace instead of reading the keyboard.\n"
+		"  --replay-fast               When used with --replay-trace, replay the trace as quickly as possible (using the recorded clock).\n"
+		"  --stats                     Record keypress to output latency histograms for each mode (and for mode transitions) and print them to stderr on exit or SIGUSR1.\n"
+		"  --batch                     Execute pointer commands (move <x> <y>, click <btn>, down <btn>, up <btn>, scroll <dir> [n], sleep <ms>) read from stdin, one per line.\n\n"
 		;
 
 	printf("%s", usage);
@@ -135,45 +165,63 @@ static void print_version()
 }
 
 
-static int drag_flag = 0;
-static int oneshot_flag = 0;
-static int click_flag = 0;
-static int x_flag = -1;
-static int y_flag = -1;
-static int record_flag = 0;
-static int mode = 0;
+static struct oneshot_request oneshot_req = {
+	.x = -1,
+	.y = -1,
+};
 
-/* Platform entry points. */
-int oneshot_main(struct platform *_platform)
+/* Also called by the daemon to service ipc requests. */
+int oneshot_run(struct oneshot_request *req)
 {
 	int ret = 0;
 	screen_t scr;
-	platform = _platform;
-
-	parse_config(config_path);
-	init_mouse();
-	init_hints();
 
 	platform->mouse_get_position(&scr, NULL, NULL);
-	if (x_flag == -1 && y_flag == -1) {
-		if (drag_flag)
-			platform->mouse_down(config_get_int("drag_button"));
+	if (req->x == -1 && req->y == -1) {
+		if (req->drag)
+			platform->mouse_down(config_get_int(CFG_DRAG_BUTTON));
 
-		ret = mode_loop(mode, oneshot_flag, record_flag);
+		ret = mode_loop(req->mode, req->oneshot, req->record);
 
-		if (drag_flag)
-			platform->mouse_up(config_get_int("drag_button"));
+		if (req->drag)
+			platform->mouse_up(config_get_int(CFG_DRAG_BUTTON));
 
 	} else {
-		platform->mouse_move(scr, x_flag, y_flag);
+		platform->mouse_move(scr, req->x, req->y);
 	}
 
-	if (click_flag)
-		platform->mouse_click(click_flag);
+	if (req->click)
+		platform->mouse_click(req->click);
+
+	platform->commit();
 
 	return ret;
 }
 
+/* Platform entry points. */
+int oneshot_main(struct platform *_platform)
+{
+	platform = _platform;
+
+	parse_config(config_path);
+	init_mouse();
+	init_hints();
+	trace_init(record_trace_path, replay_trace_path, replay_fast);
+	if (stats_flag)
+		stats_init();
+
+	return oneshot_run(&oneshot_req);
+}
+
+int batch_main(struct platform *_platform)
+{
+	platform = _platform;
+
+	parse_config(config_path);
+
+	return batch_run();
+}
+
 int daemon_main(struct platform *_platform)
 {
 	platform = _platform;
@@ -181,6 +229,10 @@ int daemon_main(struct platform *_platform)
 	parse_config(config_path);
 	init_mouse();
 	init_hints();
+	prerender_hints();
+	trace_init(record_trace_path, replay_trace_path, replay_fast);
+	if (stats_flag)
+		stats_init();
 
 	daemon_loop(config_path);
 
@@ -230,6 +282,11 @@ int main(int argc, char *argv[])
 		{"record", no_argument, NULL, 266},
 		{"drag", no_argument, NULL, 267},
 		{"screen", no_argument, NULL, 268},
+		{"batch", no_argument, NULL, 269},
+		{"record-trace", required_argument, NULL, 270},
+		{"replay-trace", required_argument, NULL, 271},
+		{"replay-fast", no_argument, NULL, 272},
+		{"stats", no_argument, NULL, 273},
 		{0}
 	};
 
@@ -251,46 +308,61 @@ int main(int argc, char *argv[])
 				foreground = 1;
 				break;
 			case 'q':
-				mode = MODE_HINTSPEC;
-				oneshot_flag = 1;
+				oneshot_req.mode = MODE_HINTSPEC;
+				oneshot_req.oneshot = 1;
 				break;
 			case 257:
-				mode = MODE_HINT;
+				oneshot_req.mode = MODE_HINT;
 				break;
 			case 258:
-				mode = MODE_GRID;
+				oneshot_req.mode = MODE_GRID;
 				break;
 			case 259:
-				mode = MODE_NORMAL;
+				oneshot_req.mode = MODE_NORMAL;
 				break;
 			case 261:
-				mode = MODE_HINT2;
+				oneshot_req.mode = MODE_HINT2;
 				break;
 			case 262:
-				mode = MODE_HISTORY;
+				oneshot_req.mode = MODE_HISTORY;
 				break;
 			case 268:
-				mode = MODE_SCREEN_SELECTION;
+				oneshot_req.mode = MODE_SCREEN_SELECTION;
 				break;
 			case 263:
-				if (!mode)
-					mode = MODE_NORMAL;
+				if (!oneshot_req.mode)
+					oneshot_req.mode = MODE_NORMAL;
 
-				oneshot_flag = 1;
+				oneshot_req.oneshot = 1;
 				break;
 			case 264:
-				click_flag = atoi(optarg);
-				oneshot_flag = 1;
+				oneshot_req.click = atoi(optarg);
+				oneshot_req.oneshot = 1;
 				break;
 			case 265:
-				sscanf(optarg, "%d %d", &x_flag, &y_flag);
-				oneshot_flag = 1;
+				sscanf(optarg, "%d %d", &oneshot_req.x, &oneshot_req.y);
+				oneshot_req.oneshot = 1;
 				break;
 			case 266:
-				record_flag = 1;
+				oneshot_req.record = 1;
 				break;
 			case 267:
-				drag_flag = 1;
+				oneshot_req.drag = 1;
+				break;
+			case 269:
+				batch_flag = 1;
+				break;
+			case 270:
+				record_trace_path = optarg;
+				break;
+			case 271:
+				replay_trace_path = optarg;
+				break;
+			case 272:
+				replay_fast = 1;
+				break;
+			case 273:
+				stats_flag = 1;
 				break;
 			case 260:
 				config_print_options();
@@ -300,7 +372,17 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (mode || oneshot_flag) {
+	/* platform_run() exits with the status returned by batch_main(). */
+	if (batch_flag) {
+		platform_run(batch_main);
+	} else if (oneshot_req.mode || oneshot_req.oneshot) {
+		int rc;
+
+		/* Let a running daemon do the work if there is one. */
+		if (!record_trace_path && !replay_trace_path && !stats_flag &&
+		    !ipc_request(&oneshot_req, config_path, &rc))
+			return rc;
+
 		platform_run(oneshot_main);
 	} else {
 		lock();
@@ -67,19 +67,34 @@ enum {
 enum option_type {
 	OPT_STRING = 1,
 	OPT_INT,
+	OPT_COLOR,
 
 	OPT_KEY,
 	OPT_BUTTON,
 };
 
-struct config_entry {
-	char key[32];
-	char value[64];
-	enum option_type type;
+enum config_option {
+#define X(id, name, val, description, type) CFG_##id,
+#include "options.h"
+#undef X
 
-	int whitelisted;
+	NR_CONFIG_OPTIONS
+};
+
+/* A oneshot invocation (see ipc.c). */
+struct oneshot_request {
+	int mode;
+	int oneshot;
+	int click;
+	int drag;
+	int record;
+	int x;
+	int y;
 
-	struct config_entry *next;
+	/* Used by the daemon to reject requests it can't faithfully run. */
+	char config_path[PATH_MAX];
+	char display[64];
+	char wayland_display[64];
 };
 
 struct histfile_ent {
@@ -97,31 +112,53 @@ struct input_event *grid_mode();
 struct input_event *normal_mode(struct input_event *start_ev, int oneshot);
 
 void init_hints();
+void prerender_hints();
 void init_normal_mode();
 void init_grid_mode();
 
-void config_input_whitelist(const char *names[], size_t n);
+void config_input_whitelist(const enum config_option options[], size_t n);
 
 const char *input_event_tostr(struct input_event *ev);
-int input_eq(struct input_event *ev, const char *str);
 int input_parse_string(struct input_event *ev, const char *s);
-int config_input_match(struct input_event *ev, const char *str);
+struct input_event *input_next_event(int timeout);
+size_t input_pending();
+void input_flush();
+int config_input_match(struct input_event *ev, enum config_option option);
 
 size_t hist_hints(struct hint *hints, int w, int h);
 
-int mouse_process_key(struct input_event *ev, const char *up_key,
-		      const char *down_key, const char *left_key,
-		      const char *right_key);
+int mouse_process_key(struct input_event *ev, enum config_option up_key,
+		      enum config_option down_key, enum config_option left_key,
+		      enum config_option right_key);
 
 void mouse_reset();
 void mouse_fast();
 void mouse_normal();
 void mouse_slow();
+int mouse_moving();
+int frame_interval(screen_t scr);
 
 void scroll_tick();
 void scroll_stop();
 void scroll_accelerate(int direction);
 void scroll_decelerate();
+int scroll_active();
+
+enum timer {
+	TIMER_FRAME,
+	TIMER_BLINK,
+	TIMER_ONESHOT,
+
+	NR_TIMERS
+};
+
+void timer_set(enum timer timer, uint64_t deadline);
+void timer_clear(enum timer timer);
+int timer_armed(enum timer timer);
+int timer_expired(enum timer timer);
+void timer_advance(enum timer timer, uint64_t interval);
+void timer_next_frame(screen_t scr);
+struct input_event *timer_next_event();
 
 void hist_add(int x, int y);
 int hist_get(int *x, int *y);
@@ -137,16 +174,37 @@ void init_mouse();
 const char *get_config_path(const char *file);
 const char *get_data_path(const char *file);
 void parse_config(const char *path);
-const char *config_get(const char *key);
-int config_get_int(const char *key);
+const char *config_get(enum config_option option);
+int config_get_int(enum config_option option);
+uint32_t config_get_color(enum config_option option);
+int config_changed(const enum config_option options[], size_t n);
+int config_keymap_serial();
 void config_print_options();
 
 uint64_t get_time_us();
+uint64_t get_real_time_us();
+void set_clock_source(uint64_t (*fn)());
+int clock_is_real();
+
+void trace_init(const char *record_path, const char *replay_path, int fast);
 
-extern struct config_entry *config;
+void stats_init();
+void stats_set_mode(int mode);
+void stats_transition();
+void stats_dump();
+
+void session_begin();
+void session_set_mode(int mode);
+void session_end();
 
 int mode_loop(int initial_mode, int oneshot, int record_history);
 void daemon_loop(const char *config_path);
+int oneshot_run(struct oneshot_request *req);
+int batch_run();
+
+int ipc_listen(const char *config_path);
+int ipc_serve(int sock);
+int ipc_request(struct oneshot_request *req, const char *config_path, int *rc);
 
 extern struct platform *platform;
 #endif
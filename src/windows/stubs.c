@@ -1,6 +1,9 @@
 #include <windows.h>
+#include <stdint.h>
 #include <stdio.h>
 
+uint64_t get_time_us();
+
 const char *get_data_path(const char *file)
 {
 	static char path[1024];
@@ -8,3 +11,20 @@ const char *get_data_path(const char *file)
 	sprintf(path, "%s\\warpd\\%s", getenv("APPDATA"), file);
 	return path;
 }
+
+/* No control socket on windows (see ipc.c). */
+int ipc_listen(const char *config_path)
+{
+	return -1;
+}
+
+int ipc_serve(int sock)
+{
+	return 0;
+}
+
+/* There is no replaceable clock on windows (see warpd.c). */
+uint64_t get_real_time_us()
+{
+	return get_time_us();
+}
@@ -0,0 +1,51 @@
+#!/bin/sh
+
+# Hint filtering microbenchmark. Runs hintspec mode against bin/warpd (built
+# with PLATFORM=headless) over MAX_HINTS labels, repeatedly narrowing the set
+# and undoing, and reports the number of keystrokes processed per second.
+#
+# Usage: test/bench.sh [<iterations>] (default: 100000)
+
+cd "$(dirname "$0")/.." || exit 1
+
+iterations=${1:-100000}
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+# 2048 (MAX_HINTS) three character labels drawn from 13 characters.
+awk 'BEGIN {
+	c = "abcdefghijklm"
+	for (i = 0; i < 2048; i++)
+		printf "%s%s%s %d %d\n",
+			substr(c, int(i / 169) + 1, 1),
+			substr(c, int(i / 13) % 13 + 1, 1),
+			substr(c, i % 13 + 1, 1),
+			i % 64 * 30, int(i / 64) * 30
+}' > "$tmp/hints"
+
+# Each iteration narrows the full set twice (to 169 and then 13 hints) and
+# undoes both steps. The final label selects a hint.
+awk -v n="$iterations" 'BEGIN {
+	c = "abcdefghijklm"
+	for (i = 0; i < n; i++)
+		printf "%s\n%s\nbackspace\nC-u\n",
+			substr(c, i % 12 + 1, 1), substr(c, i % 13 + 1, 1)
+	print "a\na\na"
+}' > "$tmp/script"
+
+: > "$tmp/config"
+
+env -i PATH="$PATH" HOME="$tmp" XDG_DATA_DIR="$tmp" \
+	WARPD_HEADLESS_SCRIPT="$tmp/script" \
+	./bin/warpd -q -c "$tmp/config" < "$tmp/hints" > /dev/null 2> "$tmp/err" || {
+	cat "$tmp/err"
+	exit 1
+}
+
+# Every keystroke is a press and a release.
+sed -n 's/^headless: \([0-9]*\) events .* in \([0-9]*\) us.*/\1 \2/p' "$tmp/err" |
+	awk '{
+		printf "hintspec: %d keystrokes over 2048 hints in %d us (%.0f keystrokes/sec)\n",
+			$1 / 2, $2, $2 ? $1 / 2 * 1E6 / $2 : 0
+	}'
@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# Runs the headless regression scripts in test/ against bin/warpd (built
+# with PLATFORM=headless) and compares their output with the corresponding
+# .expected file. Pass -u to (re)generate the expected output instead.
+#
+# Each script may start with the following directives:
+#
+#	# args: <warpd arguments>
+#	# env: <VAR>=<value>
+#	# config: <option>: <value>
+#	# stdin: <line>
+#
+# Scripts are run with a virtual clock, so the output (stdout, followed by
+# stderr) is deterministic.
+
+cd "$(dirname "$0")/.." || exit 1
+
+update=0
+[ "$1" = "-u" ] && update=1
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+failed=0
+for script in test/*.script; do
+	name=${script%.script}
+
+	sed -n 's/^# config: //p' "$script" > "$tmp/config"
+	sed -n 's/^# stdin: //p' "$script" > "$tmp/stdin"
+	args=$(sed -n 's/^# args: //p' "$script")
+	env=$(sed -n 's/^# env: //p' "$script")
+
+	env -i PATH="$PATH" HOME="$tmp" XDG_DATA_DIR="$tmp" \
+		WARPD_HEADLESS_VIRTUAL=1 WARPD_HEADLESS_SCRIPT="$script" $env \
+		./bin/warpd $args -c "$tmp/config" < "$tmp/stdin" > "$tmp/stdout" 2> "$tmp/err"
+	rc=$?
+
+	# The daemon's banner names the commit it was built from.
+	sed 's/ (built from: [^)]*)//' "$tmp/stdout" > "$tmp/out"
+	echo "exit: $rc" >> "$tmp/out"
+
+	# Elapsed (real) time is the only other nondeterministic output.
+	sed 's/ in [0-9]* us ([0-9]* [a-z]*\/sec)//' "$tmp/err" >> "$tmp/out"
+
+	if [ $update -eq 1 ]; then
+		cp "$tmp/out" "$name.expected"
+	elif diff -u "$name.expected" "$tmp/out" > "$tmp/diff"; then
+		echo "PASS: $name"
+	else
+		echo "FAIL: $name"
+		cat "$tmp/diff"
+		failed=1
+	fi
+done
+
+exit $failed